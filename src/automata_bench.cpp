@@ -0,0 +1,403 @@
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+#include "dfa.hpp"
+#include "generators.hpp"
+#include "lazy_dfa.hpp"
+#include "lnfa.hpp"
+#include "nfa.hpp"
+#include "regex.hpp"
+
+#ifndef AUTOMATA_BUILD_TYPE
+#define AUTOMATA_BUILD_TYPE ""
+#endif
+
+namespace {
+
+struct Result {
+    std::string name;
+    std::size_t iterations;
+    double seconds;
+    // Words or states processed per iteration
+    std::size_t items;
+    const char *item_kind;
+    long peak_rss_kb;
+};
+
+// Peak resident set size since the last reset, in KiB. Linux keeps it in
+// /proc, elsewhere the peak of the whole process is used.
+long get_peak_rss_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.starts_with("VmHWM:")) {
+            return std::stol(line.substr(6));
+        }
+    }
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+}
+
+struct Benchmark {
+    std::string name;
+    const char *item_kind;
+    // Builds the inputs, and returns the function to time, which processes
+    // the returned number of items per call.
+    std::function<std::function<std::size_t()>()> setup;
+};
+
+Result run_benchmark(const Benchmark &benchmark, double min_seconds) {
+    reset_peak_rss();
+    auto body = benchmark.setup();
+
+    // Like Google Benchmark, repeat until the minimum time has passed
+    using Clock = std::chrono::steady_clock;
+    std::size_t iterations = 0;
+    std::size_t items = 0;
+    auto begin = Clock::now();
+    double seconds = 0;
+    do {
+        items = body();
+        iterations++;
+        seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    } while (seconds < min_seconds);
+
+    return {benchmark.name, iterations, seconds, items, benchmark.item_kind,
+            get_peak_rss_kb()};
+}
+
+// Keep a result from being optimized away, like benchmark::DoNotOptimize
+template <typename T> void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+constexpr std::string_view dfa_alphabet = "abcd";
+
+std::vector<std::string_view> to_views(const std::vector<std::string> &words) {
+    return {words.begin(), words.end()};
+}
+
+std::vector<Benchmark> make_benchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    // Matching a corpus of words
+    auto add_word_benchmark = [&](std::string name, auto setup) {
+        benchmarks.push_back({std::move(name), "words", setup});
+    };
+
+    auto random_dfa_words = [] {
+        std::mt19937_64 rng(1);
+        auto dfa = generate_random_dfa(100000, dfa_alphabet, rng)
+                       .build<DFA>();
+        auto words = generate_words(100000, 8, 64, dfa_alphabet, rng);
+        return std::pair(std::move(dfa), std::move(words));
+    };
+
+    add_word_benchmark("dfa_accepts/random_100k", [=] {
+        auto [dfa, words] = random_dfa_words();
+        return std::function<std::size_t()>(
+            [dfa = dfa.compile(), words = std::move(words)] {
+                for (const auto &word : words) {
+                    keep(dfa.accepts(word));
+                }
+                return words.size();
+            });
+    });
+    add_word_benchmark("dfa_accepts_many/random_100k", [=] {
+        auto [dfa, words] = random_dfa_words();
+        // The views point into the shared words, so only the matching is
+        // timed, and copies of the closure stay valid
+        auto shared_words =
+            std::make_shared<const std::vector<std::string>>(std::move(words));
+        return std::function<std::size_t()>(
+            [dfa = dfa.compile(), shared_words,
+             views = to_views(*shared_words)] {
+                keep(dfa.accepts_many(views));
+                return views.size();
+            });
+    });
+    add_word_benchmark("dfa_verify_word/random_100k", [=] {
+        auto [dfa, words] = random_dfa_words();
+        return std::function<std::size_t()>(
+            [dfa = dfa.compile(), words = std::move(words)] {
+                for (const auto &word : words) {
+                    keep(dfa.verify_word(word));
+                }
+                return words.size();
+            });
+    });
+
+    auto blowup_words = [](std::size_t n) {
+        std::mt19937_64 rng(2);
+        auto nfa = generate_blowup_nfa(n).build<NFA>();
+        auto words = generate_words(20000, 8, 64, "ab", rng);
+        return std::pair(std::move(nfa), std::move(words));
+    };
+
+    add_word_benchmark("nfa_accepts/blowup_16", [=] {
+        auto [nfa, words] = blowup_words(16);
+        return std::function<std::size_t()>(
+            [simulation = BitsetNFA(nfa), words = std::move(words)] {
+                for (const auto &word : words) {
+                    keep(simulation.accepts(word));
+                }
+                return words.size();
+            });
+    });
+    add_word_benchmark("lazy_dfa_accepts/blowup_16", [=] {
+        auto [nfa, words] = blowup_words(16);
+        auto simulation = std::make_shared<BitsetNFA>(nfa);
+        auto lazy = std::make_shared<LazyDFA>(*simulation);
+        return std::function<std::size_t()>(
+            [simulation, lazy, words = std::move(words)] {
+                for (const auto &word : words) {
+                    keep(lazy->accepts(word));
+                }
+                return words.size();
+            });
+    });
+
+    // The Thompson LNFA of the blowup language
+    auto thompson_blowup = [](std::size_t n) {
+        std::string pattern = "(a|b)*a";
+        for (std::size_t i = 0; i < n; i++) {
+            pattern += "(a|b)";
+        }
+        return regex_to_lnfa(pattern);
+    };
+
+    add_word_benchmark("lnfa_accepts/thompson_blowup_16", [=] {
+        std::mt19937_64 rng(6);
+        auto lnfa = std::make_shared<LNFA>(thompson_blowup(16));
+        auto words = generate_words(20000, 8, 64, "ab", rng);
+        return std::function<std::size_t()>(
+            [lnfa, words = std::move(words)] {
+                for (const auto &word : words) {
+                    keep(lnfa->accepts(word));
+                }
+                return words.size();
+            });
+    });
+    add_word_benchmark("lambda_free_accepts/thompson_blowup_16", [=] {
+        std::mt19937_64 rng(6);
+        auto nfa = thompson_blowup(16).remove_lambdas();
+        auto words = generate_words(20000, 8, 64, "ab", rng);
+        return std::function<std::size_t()>(
+            [simulation = BitsetNFA(nfa), words = std::move(words)] {
+                for (const auto &word : words) {
+                    keep(simulation.accepts(word));
+                }
+                return words.size();
+            });
+    });
+    add_word_benchmark("lnfa_verify/lambda_chain_1000", [] {
+        std::mt19937_64 rng(3);
+        auto lnfa = std::make_shared<LNFA>(
+            generate_lambda_chain(1000, dfa_alphabet).build<LNFA>());
+        auto words = generate_words(2000, 8, 64, dfa_alphabet, rng);
+        return std::function<std::size_t()>(
+            [lnfa, words = std::move(words)] {
+                auto verifier = lnfa->create_verifier();
+                for (const auto &word : words) {
+                    keep(verifier.verify(word));
+                }
+                return words.size();
+            });
+    });
+
+    // Building automata
+    auto add_state_benchmark = [&](std::string name, auto setup) {
+        benchmarks.push_back({std::move(name), "states", setup});
+    };
+
+    add_state_benchmark("nfa_to_dfa/blowup_14", [] {
+        auto nfa = generate_blowup_nfa(14).build<NFA>();
+        return std::function<std::size_t()>([nfa = std::move(nfa)] {
+            return nfa.to_dfa().get_state_count();
+        });
+    });
+    add_state_benchmark("lnfa_to_dfa/thompson_blowup_12", [=] {
+        auto lnfa = std::make_shared<LNFA>(thompson_blowup(12));
+        return std::function<std::size_t()>(
+            [lnfa] { return lnfa->to_dfa().get_state_count(); });
+    });
+    add_state_benchmark("lnfa_remove_lambdas/thompson_blowup_12", [=] {
+        auto lnfa = std::make_shared<LNFA>(thompson_blowup(12));
+        return std::function<std::size_t()>([lnfa] {
+            keep(lnfa->remove_lambdas());
+            return lnfa->get_state_count();
+        });
+    });
+    add_state_benchmark("dfa_minimize/random_100k", [] {
+        std::mt19937_64 rng(4);
+        auto dfa = generate_random_dfa(100000, dfa_alphabet, rng).build<DFA>();
+        return std::function<std::size_t()>([dfa = std::move(dfa)] {
+            keep(dfa.minimize());
+            return dfa.get_state_count();
+        });
+    });
+    add_state_benchmark("dfa_compile/random_100k", [] {
+        std::mt19937_64 rng(5);
+        auto dfa = generate_random_dfa(100000, dfa_alphabet, rng).build<DFA>();
+        return std::function<std::size_t()>([dfa = std::move(dfa)] {
+            keep(dfa.compile());
+            return dfa.get_state_count();
+        });
+    });
+
+    return benchmarks;
+}
+
+void write_json_string(std::ostream &os, std::string_view string) {
+    os << '"';
+    for (auto symbol : string) {
+        if (symbol == '"' || symbol == '\\') {
+            os << '\\';
+        }
+        os << symbol;
+    }
+    os << '"';
+}
+
+// In the layout of Google Benchmark's JSON output, with the item kind and
+// peak RSS added to every benchmark.
+void write_json(std::ostream &os, const std::vector<Result> &results,
+                const char *executable) {
+    char date[32];
+    auto now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z",
+                  std::localtime(&now));
+
+    os << "{\n  \"context\": {\n";
+    os << "    \"date\": ";
+    write_json_string(os, date);
+    os << ",\n    \"executable\": ";
+    write_json_string(os, executable);
+    os << ",\n    \"num_cpus\": " << std::thread::hardware_concurrency();
+    os << ",\n    \"library_build_type\": ";
+    write_json_string(os, AUTOMATA_BUILD_TYPE);
+    os << "\n  },\n  \"benchmarks\": [";
+
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const auto &result = results[i];
+        auto seconds_per_iteration = result.seconds / result.iterations;
+        os << (i == 0 ? "\n" : ",\n") << "    {\n      \"name\": ";
+        write_json_string(os, result.name);
+        os << ",\n      \"iterations\": " << result.iterations
+           << ",\n      \"real_time\": " << seconds_per_iteration * 1e9
+           << ",\n      \"time_unit\": \"ns\""
+           << ",\n      \"items_per_second\": "
+           << result.items / seconds_per_iteration
+           << ",\n      \"item_kind\": ";
+        write_json_string(os, result.item_kind);
+        os << ",\n      \"peak_rss_kb\": " << result.peak_rss_kb
+           << "\n    }";
+    }
+    os << "\n  ]\n}\n";
+}
+
+void write_table_row(const Result &result) {
+    auto seconds_per_iteration = result.seconds / result.iterations;
+    std::printf("%-40s %12.3f ms %10zu %12.4g %s/s %10.1f MiB\n",
+                result.name.c_str(), seconds_per_iteration * 1e3,
+                result.iterations, result.items / seconds_per_iteration,
+                result.item_kind, result.peak_rss_kb / 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    // Pass --json for JSON output, --filter TEXT to run only benchmarks
+    // whose name contains TEXT, and --min-time SECONDS to change how long
+    // every benchmark is repeated. --corpus KIND SIZE writes a generated
+    // input instead: a random-dfa or blowup-nfa for nfa2dfa and
+    // minimize_dfa, a lambda-chain with 1000 words for lnfa_verify, or
+    // words for dfa_verify.
+    bool is_json = false;
+    std::string filter;
+    double min_seconds = 0.5;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg(argv[i]);
+        if (arg == "--json") {
+            is_json = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_seconds = std::stod(argv[++i]);
+        } else if (arg == "--corpus" && i + 2 < argc) {
+            std::string_view kind(argv[i + 1]);
+            std::size_t size = std::stoul(argv[i + 2]);
+            std::mt19937_64 rng(size);
+            if (kind == "random-dfa") {
+                std::cout << generate_random_dfa(size, dfa_alphabet, rng);
+            } else if (kind == "blowup-nfa") {
+                std::cout << generate_blowup_nfa(size);
+            } else if (kind == "lambda-chain") {
+                std::cout << generate_lambda_chain(size, dfa_alphabet);
+                auto words = generate_words(1000, 8, 64, dfa_alphabet, rng);
+                std::cout << words.size() << '\n';
+                for (const auto &word : words) {
+                    std::cout << word << '\n';
+                }
+            } else if (kind == "words") {
+                auto words = generate_words(size, 8, 64, dfa_alphabet, rng);
+                std::cout << words.size() << '\n';
+                for (const auto &word : words) {
+                    std::cout << word << '\n';
+                }
+            } else {
+                return 1;
+            }
+            return 0;
+        } else {
+            return 1;
+        }
+    }
+
+    std::string_view build_type(AUTOMATA_BUILD_TYPE);
+    if (!build_type.starts_with("Rel")) {
+        std::cerr << "***WARNING*** automata was built without optimizations,"
+                     " timings will be off\n";
+    }
+
+    if (!is_json) {
+        std::printf("%-40s %15s %10s %19s %14s\n", "Benchmark", "Time",
+                    "Iterations", "Rate", "Peak RSS");
+    }
+
+    std::vector<Result> results;
+    for (const auto &benchmark : make_benchmarks()) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        results.push_back(run_benchmark(benchmark, min_seconds));
+        if (!is_json) {
+            write_table_row(results.back());
+            std::fflush(stdout);
+        }
+    }
+
+    if (is_json) {
+        write_json(std::cout, results, argv[0]);
+    }
+
+    return 0;
+}
@@ -1,6 +1,45 @@
 #include "automaton.hpp"
 #include <memory>
+#include <utility>
 
-void Automaton::set_initial_state(StateType state) { initial_state = state; }
+void Automaton::set_initial_state(StateType state) {
+    initial_state = state;
+    transition_graph.add_state(state);
+    invalidate_caches();
+}
 
-void Automaton::add_final_state(StateType state) { final_states.insert(state); }
+void Automaton::add_final_state(StateType state) {
+    final_states.insert(state);
+    invalidate_caches();
+}
+
+Automaton::Automaton(const Automaton &other)
+    : initial_state(other.initial_state), final_states(other.final_states),
+      transition_graph(other.get_frozen_graph()) {}
+
+Automaton::Automaton(Automaton &&other) noexcept
+    : initial_state(other.initial_state),
+      final_states(std::move(other.final_states)),
+      transition_graph(std::move(other.transition_graph)) {}
+
+Automaton &Automaton::operator=(const Automaton &other) {
+    if (this != &other) {
+        initial_state = other.initial_state;
+        final_states = other.final_states;
+        transition_graph = other.get_frozen_graph();
+    }
+    return *this;
+}
+
+Automaton &Automaton::operator=(Automaton &&other) noexcept {
+    initial_state = other.initial_state;
+    final_states = std::move(other.final_states);
+    transition_graph = std::move(other.transition_graph);
+    return *this;
+}
+
+const TransitionGraph &Automaton::get_frozen_graph() const {
+    std::lock_guard lock(freeze_mutex);
+    transition_graph.freeze();
+    return transition_graph;
+}
@@ -1,47 +1,67 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "transition_graph.hpp"
+
 class Automaton {
 public:
-    using StateType = int;
+    using StateType = TransitionGraph::StateType;
     using SymbolType = std::optional<char>;
 
-    struct QueuedState {
-        StateType state;
-        std::optional<StateType> origin;
-    };
+private:
+    // Serializes freezing by const methods, see get_frozen_graph
+    mutable std::mutex freeze_mutex;
 
 protected:
     StateType initial_state;
     std::unordered_set<StateType> final_states;
+    // Mutable so that const methods can freeze it
+    mutable TransitionGraph transition_graph;
+
+    explicit Automaton(bool is_deterministic = false)
+        : transition_graph(is_deterministic) {}
+
+    // Copies get their own mutex
+    Automaton(const Automaton &other);
+    Automaton(Automaton &&other) noexcept;
+    Automaton &operator=(const Automaton &other);
+    Automaton &operator=(Automaton &&other) noexcept;
+
+    // Called whenever the automaton is modified, so that subclasses can drop
+    // data derived from it.
+    virtual void invalidate_caches() {}
+
+    /**
+     * The transition graph, frozen first if it was modified since the last
+     * freeze. Const methods may run concurrently, so this locks.
+     */
+    [[nodiscard]] const TransitionGraph &get_frozen_graph() const;
 
 public:
+    virtual ~Automaton() = default;
+
     void set_initial_state(StateType state);
+    [[nodiscard]] StateType get_initial_state() const { return initial_state; }
     virtual void add_state(StateType state) = 0;
+    [[nodiscard]] std::size_t get_state_count() const {
+        return transition_graph.get_state_count();
+    }
     void add_final_state(StateType state);
+
+    /**
+     * Pack the transitions for reading. Methods which read the transitions
+     * freeze the automaton when needed, so this only chooses when the cost
+     * is paid.
+     */
+    void freeze() { transition_graph.freeze(); }
+
     virtual std::optional<std::vector<StateType>>
     verify_word(const std::string &word) = 0;
 };
-
-template <typename StateT>
-std::vector<StateT>
-build_state_chain(const std::vector<Automaton::QueuedState> &state_queue) {
-    std::vector<StateT> chain;
-
-    // Start from the last queued state
-    auto current_state = state_queue.back();
-    while (current_state.origin.has_value()) {
-        chain.push_back(current_state.state);
-        current_state = state_queue[current_state.origin.value()];
-    }
-    // Also add final state
-    chain.push_back(current_state.state);
-
-    return chain;
-}
@@ -0,0 +1,403 @@
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "bitset_nfa.hpp"
+#include "lnfa.hpp"
+#include "nfa.hpp"
+#include "stats.hpp"
+
+template <typename ClosureFn>
+void BitsetNFA::build(const TransitionGraph &graph, StateType initial_state,
+                      const std::unordered_set<StateType> &final_state_names,
+                      ClosureFn &&for_each_in_closure) {
+    // Keep the graph's numbering
+    const auto state_count = graph.get_state_count();
+    for (std::size_t state = 0; state < state_count; state++) {
+        state_names.push_back(graph.get_state_name(state));
+    }
+
+    // Number the alphabet. Lambda-transitions are already folded into the
+    // closures, so they get no symbol.
+    symbol_indices.fill(-1);
+    for (std::size_t state = 0; state < state_count; state++) {
+        for (auto edge : graph.get_edges(state)) {
+            if (edge.symbol == TransitionGraph::lambda_symbol) {
+                continue;
+            }
+
+            auto &symbol_index = symbol_indices[edge.symbol];
+            if (symbol_index == -1) {
+                symbol_index = static_cast<std::int16_t>(symbol_count++);
+                alphabet.push_back(TransitionGraph::to_char(edge.symbol));
+            }
+        }
+    }
+
+    word_count = StateSet::get_word_count(state_count);
+
+    StateSet reached_states(state_count);
+    std::vector<IndexType> reached_list;
+    successor_indices.assign(state_count * symbol_count, no_successors);
+    for (std::size_t src_state = 0; src_state < state_count; src_state++) {
+        build_row(graph, src_state, for_each_in_closure, reached_states,
+                  reached_list);
+    }
+
+    build_state_sets(graph, initial_state, final_state_names,
+                     for_each_in_closure);
+}
+
+template <typename ClosureFn>
+void BitsetNFA::build_state_sets(
+    const TransitionGraph &graph, StateType initial_state,
+    const std::unordered_set<StateType> &final_state_names,
+    ClosureFn &&for_each_in_closure) {
+    const auto state_count = graph.get_state_count();
+    initial_states = StateSet(state_count);
+    for_each_in_closure(graph.find_state(initial_state),
+                        [&](IndexType state) { initial_states.insert(state); });
+
+    final_states = StateSet(state_count);
+    for (auto final_state : final_state_names) {
+        auto index = graph.find_state(final_state);
+        if (index != TransitionGraph::no_state) {
+            final_states.insert(index);
+        }
+    }
+}
+
+template <typename ClosureFn>
+void BitsetNFA::build_row(const TransitionGraph &graph, IndexType state,
+                          ClosureFn &&for_each_in_closure,
+                          StateSet &reached_states,
+                          std::vector<IndexType> &reached_list) {
+    // Edges are sorted by symbol, so the edges of a symbol are adjacent,
+    // and lambda-edges come last
+    auto edges = graph.get_edges(state);
+    auto edge = edges.begin();
+    while (edge != edges.end() &&
+           edge->symbol != TransitionGraph::lambda_symbol) {
+        const auto symbol = edge->symbol;
+        for (; edge != edges.end() && edge->symbol == symbol; edge++) {
+            for_each_in_closure(edge->dest, [&](IndexType reached_state) {
+                if (!reached_states.contains(reached_state)) {
+                    reached_states.insert(reached_state);
+                    reached_list.push_back(reached_state);
+                }
+            });
+        }
+
+        successor_indices[state * symbol_count + symbol_indices[symbol]] =
+            static_cast<IndexType>(successors.size());
+        Successors found{};
+        found.count = static_cast<IndexType>(reached_list.size());
+        // A mask is worth it once it is no larger than the list
+        found.is_dense = reached_list.size() * sizeof(IndexType) >=
+                         word_count * sizeof(StateSet::WordType);
+        if (found.is_dense) {
+            found.offset = static_cast<IndexType>(masks.size());
+            masks.resize(masks.size() + word_count, 0);
+            auto *mask = masks.data() + found.offset;
+            for (auto reached_state : reached_list) {
+                mask[reached_state / StateSet::word_bits] |=
+                    StateSet::WordType(1)
+                    << (reached_state % StateSet::word_bits);
+            }
+        } else {
+            std::ranges::sort(reached_list);
+            found.offset = static_cast<IndexType>(successor_lists.size());
+            successor_lists.insert(successor_lists.end(), reached_list.begin(),
+                                   reached_list.end());
+        }
+        successors.push_back(found);
+
+        for (auto reached_state : reached_list) {
+            reached_states.get_words()[reached_state / StateSet::word_bits] = 0;
+        }
+        reached_list.clear();
+    }
+}
+
+BitsetNFA::BitsetNFA(const NFA &nfa) {
+    build(nfa.get_frozen_graph(), nfa.initial_state, nfa.final_states,
+          [](IndexType state, auto &&fn) { fn(state); });
+}
+
+BitsetNFA::BitsetNFA(const LNFA &lnfa) {
+    if (!lnfa.are_lambda_closures_built) {
+        throw std::logic_error("LNFA lambda closures are not built");
+    }
+
+    build(lnfa.get_frozen_graph(), lnfa.initial_state, lnfa.final_states,
+          [&](IndexType state, auto &&fn) {
+              lnfa.for_each_in_lambda_closure(state, fn);
+          });
+}
+
+void BitsetNFA::compact(std::size_t old_symbol_count,
+                        std::size_t old_word_count) {
+    const auto state_count = state_names.size();
+    std::vector<IndexType> new_indices(state_count * symbol_count,
+                                       no_successors);
+    std::vector<Successors> new_successors;
+    std::vector<StateSet::WordType> new_masks;
+    std::vector<IndexType> new_lists;
+
+    const auto old_state_count =
+        old_symbol_count == 0 ? 0
+                              : successor_indices.size() / old_symbol_count;
+    for (std::size_t state = 0; state < old_state_count; state++) {
+        for (std::size_t symbol = 0; symbol < old_symbol_count; symbol++) {
+            auto index = successor_indices[state * old_symbol_count + symbol];
+            if (index == no_successors) {
+                continue;
+            }
+
+            auto found = successors[index];
+            if (found.is_dense) {
+                auto old_mask = masks.begin() + found.offset;
+                found.offset = static_cast<IndexType>(new_masks.size());
+                new_masks.insert(new_masks.end(), old_mask,
+                                 old_mask + old_word_count);
+                new_masks.resize(found.offset + word_count, 0);
+            } else {
+                auto old_list = successor_lists.begin() + found.offset;
+                found.offset = static_cast<IndexType>(new_lists.size());
+                new_lists.insert(new_lists.end(), old_list,
+                                 old_list + found.count);
+            }
+            new_indices[state * symbol_count + symbol] =
+                static_cast<IndexType>(new_successors.size());
+            new_successors.push_back(found);
+        }
+    }
+
+    successor_indices = std::move(new_indices);
+    successors = std::move(new_successors);
+    masks = std::move(new_masks);
+    successor_lists = std::move(new_lists);
+    stale_size = 0;
+}
+
+void BitsetNFA::update(const LNFA &lnfa, const StateSet &changed_states) {
+    const auto &graph = lnfa.get_frozen_graph();
+    const auto old_state_count = state_names.size();
+    const auto state_count = graph.get_state_count();
+    for (auto state = old_state_count; state < state_count; state++) {
+        state_names.push_back(graph.get_state_name(state));
+    }
+
+    // Rows to rebuild. States keep their indices, so new states come last.
+    StateSet stale_rows = changed_states;
+    stale_rows.resize(state_count);
+    for (auto state = old_state_count; state < state_count; state++) {
+        stale_rows.insert(state);
+    }
+
+    // New symbols can only appear on the rebuilt rows, and are numbered
+    // after the old ones
+    const auto old_symbol_count = symbol_count;
+    stale_rows.for_each([&](std::size_t state) {
+        for (auto edge : graph.get_edges(state)) {
+            if (edge.symbol == TransitionGraph::lambda_symbol) {
+                continue;
+            }
+
+            auto &symbol_index = symbol_indices[edge.symbol];
+            if (symbol_index == -1) {
+                symbol_index = static_cast<std::int16_t>(symbol_count++);
+                alphabet.push_back(TransitionGraph::to_char(edge.symbol));
+            }
+        }
+    });
+
+    // Drop the old successors of rebuilt rows
+    changed_states.for_each([&](std::size_t state) {
+        if (state >= old_state_count) {
+            return;
+        }
+        for (std::size_t symbol = 0; symbol < old_symbol_count; symbol++) {
+            auto &index = successor_indices[state * old_symbol_count + symbol];
+            if (index == no_successors) {
+                continue;
+            }
+
+            const auto &found = successors[index];
+            stale_size += found.is_dense
+                              ? word_count * sizeof(StateSet::WordType)
+                              : found.count * sizeof(IndexType);
+            index = no_successors;
+        }
+    });
+
+    const auto old_word_count = word_count;
+    word_count = StateSet::get_word_count(state_count);
+    const auto total_size = masks.size() * sizeof(StateSet::WordType) +
+                            successor_lists.size() * sizeof(IndexType);
+    if (symbol_count != old_symbol_count || word_count != old_word_count ||
+        stale_size * 2 > total_size) {
+        compact(old_symbol_count, old_word_count);
+    } else {
+        successor_indices.resize(state_count * symbol_count, no_successors);
+    }
+
+    StateSet reached_states(state_count);
+    std::vector<IndexType> reached_list;
+    auto for_each_in_closure = [&](IndexType state, auto &&fn) {
+        lnfa.for_each_in_lambda_closure(state, fn);
+    };
+    stale_rows.for_each([&](std::size_t state) {
+        build_row(graph, state, for_each_in_closure, reached_states,
+                  reached_list);
+    });
+
+    build_state_sets(graph, lnfa.initial_state, lnfa.final_states,
+                     for_each_in_closure);
+}
+
+bool BitsetNFA::accepts(std::string_view word) const {
+    Run run(*this);
+    for (auto symbol : word) {
+        if (!run.advance(symbol)) {
+            return false;
+        }
+    }
+
+    return run.is_accepting();
+}
+
+std::optional<std::vector<BitsetNFA::StateType>>
+BitsetNFA::trace(std::string_view word) const {
+    Run run(*this, true);
+    for (auto symbol : word) {
+        if (!run.advance(symbol)) {
+            return {};
+        }
+    }
+
+    if (!run.is_accepting()) {
+        return {};
+    }
+
+    std::vector<StateType> names;
+    for (auto state : run.build_trace()) {
+        names.push_back(state_names[state]);
+    }
+    return names;
+}
+
+BitsetNFA::Run::Run(const BitsetNFA &nfa, bool is_recording)
+    : nfa(&nfa), current_states(nfa.initial_states),
+      next_states(nfa.get_state_count()), is_recording(is_recording) {}
+
+void BitsetNFA::Run::reset() {
+    current_states = nfa->initial_states;
+    records.clear();
+    step_offsets.clear();
+}
+
+void BitsetNFA::Run::set_states(const StateSet &states) {
+    current_states = states;
+    records.clear();
+    step_offsets.clear();
+}
+
+bool BitsetNFA::Run::advance(char symbol) {
+    if (is_recording) {
+        step_offsets.push_back(records.size());
+    }
+
+    next_states.clear();
+    auto symbol_index = nfa->get_symbol_index(symbol);
+    if (symbol_index >= 0) {
+        current_states.for_each([&](std::size_t state) {
+            if (!is_recording) {
+                nfa->add_successors(state, symbol_index, next_states);
+                return;
+            }
+
+            // Only record states which were not reached before in this step
+            const auto *found = nfa->find_successors(state, symbol_index);
+            if (found == nullptr) {
+                return;
+            }
+
+            if (!found->is_dense) {
+                for (IndexType i = 0; i < found->count; i++) {
+                    auto reached_state =
+                        nfa->successor_lists[found->offset + i];
+                    if (!next_states.contains(reached_state)) {
+                        next_states.insert(reached_state);
+                        records.emplace_back(reached_state, state);
+                    }
+                }
+                return;
+            }
+
+            auto &next_words = next_states.get_words();
+            const auto *mask = nfa->masks.data() + found->offset;
+            for (std::size_t i = 0; i < next_words.size(); i++) {
+                auto new_bits = mask[i] & ~next_words[i];
+                next_words[i] |= mask[i];
+                while (new_bits != 0) {
+                    IndexType reached_state =
+                        i * StateSet::word_bits + std::countr_zero(new_bits);
+                    records.emplace_back(reached_state, state);
+                    new_bits &= new_bits - 1;
+                }
+            }
+        });
+    }
+
+    std::swap(current_states, next_states);
+    AUTOMATA_STATS_ADD(simulation_steps, 1);
+    AUTOMATA_STATS_ADD(simulation_frontier_states, current_states.count());
+    AUTOMATA_STATS_MAX(simulation_frontier_peak, current_states.count());
+    return !current_states.empty();
+}
+
+bool BitsetNFA::Run::is_accepting() const {
+    return nfa->contains_final_state(current_states);
+}
+
+std::vector<BitsetNFA::IndexType> BitsetNFA::Run::build_trace() const {
+    const auto step_count = step_offsets.size();
+    std::vector<IndexType> trace(step_count + 1);
+
+    // Start from any active final state
+    current_states.for_each([&](std::size_t state) {
+        if (nfa->final_states.contains(state)) {
+            trace[step_count] = state;
+        }
+    });
+
+    // Follow predecessors back to an initial state
+    for (auto step = step_count; step > 0; step--) {
+        auto records_begin = records.begin() + step_offsets[step - 1];
+        auto records_end = step < step_count
+                               ? records.begin() + step_offsets[step]
+                               : records.end();
+        auto record = std::find_if(
+            records_begin, records_end,
+            [&](const auto &record) { return record.first == trace[step]; });
+        trace[step - 1] = record->second;
+    }
+
+    return trace;
+}
+
+void BitsetNFA::Matcher::feed(std::span<const char> chunk) {
+    for (auto symbol : chunk) {
+        if (run.is_dead()) {
+            return;
+        }
+        run.advance(symbol);
+    }
+}
+
+bool BitsetNFA::Matcher::finish() {
+    auto is_accepted = run.is_accepting();
+    run.reset();
+    return is_accepted;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "automaton.hpp"
+#include "state_set.hpp"
+#include "transition_graph.hpp"
+
+class NFA;
+class LNFA;
+
+/**
+ * An NFA or LNFA compiled for state-set simulation.
+ *
+ * States are numbered as in the automaton's TransitionGraph, and the set of
+ * active states is kept as a dense bitset. For every (state, symbol) pair
+ * with transitions, the successors are precomputed, already including the
+ * lambda closures of the reached states, so a step never queues a state
+ * twice. Successors are kept as a mask when they are many, so that adding
+ * them is a word-parallel OR, and as a list of states otherwise, which keeps
+ * memory linear in the number of successors for large automata.
+ */
+class BitsetNFA {
+public:
+    using StateType = Automaton::StateType;
+    using IndexType = std::uint32_t;
+
+    static constexpr IndexType no_successors = UINT32_MAX;
+
+    /**
+     * The active state set of a simulation in progress.
+     *
+     * When recording, the predecessor of every newly reached state is kept
+     * for each step, so that a witness chain can be rebuilt afterwards.
+     */
+    class Run {
+    private:
+        const BitsetNFA *nfa;
+        StateSet current_states;
+        StateSet next_states;
+
+        bool is_recording;
+        // (state, predecessor) for every state reached in each step
+        std::vector<std::pair<IndexType, IndexType>> records;
+        std::vector<std::size_t> step_offsets;
+
+    public:
+        explicit Run(const BitsetNFA &nfa, bool is_recording = false);
+
+        /** Go back to the initial states, dropping recorded steps. */
+        void reset();
+
+        /**
+         * Advance from current states via symbol.
+         * Returns false if no state is active anymore.
+         */
+        bool advance(char symbol);
+
+        [[nodiscard]] bool is_accepting() const;
+        [[nodiscard]] bool is_dead() const { return current_states.empty(); }
+        [[nodiscard]] const StateSet &get_states() const {
+            return current_states;
+        }
+        /** Continue from the given states, dropping recorded steps. */
+        void set_states(const StateSet &states);
+
+        /**
+         * Rebuild the states visited on the way to an active final state,
+         * one per step, starting with an initial state. Requires recording
+         * and an accepting run.
+         */
+        [[nodiscard]] std::vector<IndexType> build_trace() const;
+    };
+
+    /**
+     * Matches input arriving in chunks, without buffering it. The matcher
+     * borrows the BitsetNFA, and its whole state is the set of active
+     * states, which can be saved and restored.
+     */
+    class Matcher {
+    public:
+        using Snapshot = StateSet;
+
+    private:
+        Run run;
+
+    public:
+        explicit Matcher(const BitsetNFA &nfa) : run(nfa) {}
+
+        /** Continue matching with the next chunk of input. */
+        void feed(std::span<const char> chunk);
+
+        [[nodiscard]] bool is_accepting() const { return run.is_accepting(); }
+        /** True if no continuation of the input can be accepted. */
+        [[nodiscard]] bool is_dead() const { return run.is_dead(); }
+
+        /**
+         * End the input. Returns whether all input fed so far is accepted,
+         * and starts over for the next input.
+         */
+        bool finish();
+
+        [[nodiscard]] Snapshot save() const { return run.get_states(); }
+        void restore(const Snapshot &snapshot) { run.set_states(snapshot); }
+    };
+
+private:
+    std::vector<StateType> state_names;
+    std::array<std::int16_t, 256> symbol_indices;
+    std::vector<char> alphabet;
+    std::size_t symbol_count = 0;
+    std::size_t word_count = 0;
+
+    // The successors of a state via a symbol: count states, either as a
+    // mask of word_count words at offset into masks, or as a sorted list at
+    // offset into successor_lists
+    struct Successors {
+        IndexType offset;
+        IndexType count;
+        bool is_dense;
+    };
+
+    // Index into successors for every (state, symbol), or no_successors
+    std::vector<IndexType> successor_indices;
+    std::vector<Successors> successors;
+    std::vector<StateSet::WordType> masks;
+    std::vector<IndexType> successor_lists;
+    // Bytes of masks and successor_lists which are no longer indexed
+    std::size_t stale_size = 0;
+
+    StateSet initial_states;
+    StateSet final_states;
+
+    // Add the successors of every transition.
+    // for_each_in_closure(dest, fn) calls fn for the states reached via
+    // lambda from dest, including dest itself.
+    template <typename ClosureFn>
+    void build(const TransitionGraph &graph, StateType initial_state,
+               const std::unordered_set<StateType> &final_state_names,
+               ClosureFn &&for_each_in_closure);
+
+    // Store the successors of state via every symbol. reached_states must
+    // be empty, and is left empty.
+    template <typename ClosureFn>
+    void build_row(const TransitionGraph &graph, IndexType state,
+                   ClosureFn &&for_each_in_closure, StateSet &reached_states,
+                   std::vector<IndexType> &reached_list);
+
+    // Set the initial states, with their closures, and the final states
+    template <typename ClosureFn>
+    void
+    build_state_sets(const TransitionGraph &graph, StateType initial_state,
+                     const std::unordered_set<StateType> &final_state_names,
+                     ClosureFn &&for_each_in_closure);
+
+    // Copy the indexed successors to new storage, laid out for the current
+    // symbol and word counts
+    void compact(std::size_t old_symbol_count, std::size_t old_word_count);
+
+    // Catch up with states, edges and lambda closures added to the LNFA
+    // since the last build or update. The successors of changed_states
+    // and of new states are rebuilt, and the others are kept.
+    void update(const LNFA &lnfa, const StateSet &changed_states);
+
+    [[nodiscard]] const Successors *
+    find_successors(IndexType state, std::size_t symbol_index) const {
+        auto index = successor_indices[state * symbol_count + symbol_index];
+        return index == no_successors ? nullptr : &successors[index];
+    }
+
+public:
+    explicit BitsetNFA(const NFA &nfa);
+    /** Requires the LNFA's lambda closures to be built. */
+    explicit BitsetNFA(const LNFA &lnfa);
+
+    [[nodiscard]] std::size_t get_state_count() const {
+        return state_names.size();
+    }
+    [[nodiscard]] std::size_t get_symbol_count() const { return symbol_count; }
+    [[nodiscard]] std::size_t get_word_count() const { return word_count; }
+
+    /** Index of symbol in the alphabet, or -1 if it is not in it. */
+    [[nodiscard]] int get_symbol_index(char symbol) const {
+        return symbol_indices[static_cast<unsigned char>(symbol)];
+    }
+
+    [[nodiscard]] char get_symbol(std::size_t symbol_index) const {
+        return alphabet[symbol_index];
+    }
+
+    /** Check if state has any successor via the symbol index. */
+    [[nodiscard]] bool has_successors(IndexType state,
+                                      std::size_t symbol_index) const {
+        return find_successors(state, symbol_index) != nullptr;
+    }
+
+    /** Add the successors of state via the symbol index to states. */
+    void add_successors(IndexType state, std::size_t symbol_index,
+                        StateSet &states) const {
+        const auto *found = find_successors(state, symbol_index);
+        if (found == nullptr) {
+            return;
+        }
+
+        if (found->is_dense) {
+            states.unite(masks.data() + found->offset);
+            return;
+        }
+        for (IndexType i = 0; i < found->count; i++) {
+            states.insert(successor_lists[found->offset + i]);
+        }
+    }
+
+    /**
+     * Call fn(dest) for every successor of state via the symbol index, in
+     * increasing order.
+     */
+    template <typename Fn>
+    void for_each_successor(IndexType state, std::size_t symbol_index,
+                            Fn &&fn) const {
+        const auto *found = find_successors(state, symbol_index);
+        if (found == nullptr) {
+            return;
+        }
+
+        if (found->is_dense) {
+            StateSet::for_each(
+                std::span(masks.data() + found->offset, word_count), fn);
+            return;
+        }
+        for (IndexType i = 0; i < found->count; i++) {
+            fn(successor_lists[found->offset + i]);
+        }
+    }
+
+    [[nodiscard]] const StateSet &get_initial_states() const {
+        return initial_states;
+    }
+    [[nodiscard]] bool is_final(IndexType state) const {
+        return final_states.contains(state);
+    }
+    [[nodiscard]] bool contains_final_state(const StateSet &states) const {
+        return states.intersects(final_states);
+    }
+    [[nodiscard]] bool
+    contains_final_state(std::span<const StateSet::WordType> states) const {
+        return final_states.intersects(states);
+    }
+
+    [[nodiscard]] StateType get_state_name(IndexType state) const {
+        return state_names[state];
+    }
+
+    /** Check if the word is accepted, without recording a chain. */
+    [[nodiscard]] bool accepts(std::string_view word) const;
+
+    /**
+     * Original names of the states visited on the way to a final state, one
+     * per step, starting with an initial state.
+     */
+    [[nodiscard]] std::optional<std::vector<StateType>>
+    trace(std::string_view word) const;
+
+    friend class LNFA;
+};
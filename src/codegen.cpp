@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "codegen.hpp"
+
+namespace {
+
+// Write a symbol inside a C++ character or string literal, with octal
+// escapes for anything but letters and digits, which never run into the
+// following characters
+void write_escaped(std::ostream &os, char symbol) {
+    auto byte = static_cast<unsigned char>(symbol);
+    if ((byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z') ||
+        (byte >= 'A' && byte <= 'Z')) {
+        os << symbol;
+        return;
+    }
+    os << '\\' << char('0' + (byte >> 6)) << char('0' + ((byte >> 3) & 7))
+       << char('0' + (byte & 7));
+}
+
+// Bytes first..last all lead to dest
+struct ByteRange {
+    unsigned first;
+    unsigned last;
+    CompiledDFA::IndexType dest;
+};
+
+// Jump to the destination of the byte in symbol, out of ranges which are
+// sorted and cover all bytes, by halving them until one is left
+void write_range_tree(std::ostream &os, std::span<const ByteRange> ranges,
+                      int depth) {
+    const std::string indent(4 * depth, ' ');
+    if (ranges.size() == 1) {
+        if (ranges.front().dest == CompiledDFA::dead_state) {
+            os << indent << "return false;\n";
+        } else {
+            os << indent << "goto state_" << ranges.front().dest - 1 << ";\n";
+        }
+        return;
+    }
+
+    auto middle = ranges.size() / 2;
+    os << indent << "if (symbol <= " << ranges[middle - 1].last << ") {\n";
+    write_range_tree(os, ranges.first(middle), depth + 1);
+    os << indent << "} else {\n";
+    write_range_tree(os, ranges.subspan(middle), depth + 1);
+    os << indent << "}\n";
+}
+
+// The keywords of C++20, and the alternative tokens of operators
+constexpr std::string_view keywords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor",
+    "bool", "break", "case", "catch", "char", "char16_t", "char32_t", "char8_t",
+    "class", "co_await", "co_return", "co_yield", "compl", "concept", "const",
+    "const_cast", "consteval", "constexpr", "constinit", "continue", "decltype",
+    "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+    "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept",
+    "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private",
+    "protected", "public", "register", "reinterpret_cast", "requires", "return",
+    "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+    "struct", "switch", "template", "this", "thread_local", "throw", "true",
+    "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+};
+
+} // namespace
+
+bool is_identifier(std::string_view name) {
+    auto is_word_char = [](char character) {
+        return (character >= '0' && character <= '9') ||
+               (character >= 'a' && character <= 'z') ||
+               (character >= 'A' && character <= 'Z') || character == '_';
+    };
+    return !name.empty() && !(name.front() >= '0' && name.front() <= '9') &&
+           std::ranges::all_of(name, is_word_char) &&
+           std::ranges::find(keywords, name) == std::end(keywords);
+}
+
+void write_static_dfa_header(std::ostream &os, const DFA &dfa,
+                             std::string_view name) {
+    const auto canonical = dfa.canonicalize();
+    const auto alphabet = canonical.get_alphabet();
+    const auto compiled = canonical.compile();
+    // Compiled states are shifted by one after the dead state, as in
+    // StaticDFA
+    const auto state_count = compiled.get_state_count() - 1;
+
+    os << "// Generated by write_static_dfa_header. Do not edit.\n"
+       << "#pragma once\n\n"
+       << "#include \"static_dfa.hpp\"\n\n"
+       << "inline constexpr StaticDFA<" << state_count << ", "
+       << alphabet.size() << "> " << name << "(\n";
+
+    os << "    \"";
+    for (auto symbol : alphabet) {
+        write_escaped(os, symbol);
+    }
+    os << "\", " << compiled.get_initial_state() - 1 << ",\n";
+
+    std::vector<std::size_t> final_states;
+    for (std::size_t state = 1; state <= state_count; state++) {
+        if (compiled.is_final(state)) {
+            final_states.push_back(state - 1);
+        }
+    }
+    os << "    {";
+    for (std::size_t i = 0; i < final_states.size(); i++) {
+        os << (i == 0 ? "" : ", ") << final_states[i];
+    }
+    os << "},\n";
+
+    os << "    {";
+    bool is_first = true;
+    for (std::size_t state = 1; state <= state_count; state++) {
+        for (auto symbol : alphabet) {
+            auto dest = compiled.next_state(state, symbol);
+            if (dest == CompiledDFA::dead_state) {
+                continue;
+            }
+            os << (is_first ? "\n" : ",\n") << "        {" << state - 1 << ", "
+               << dest - 1 << ", '";
+            write_escaped(os, symbol);
+            os << "'}";
+            is_first = false;
+        }
+    }
+    os << (is_first ? "" : "\n    ") << "});\n";
+}
+
+void write_goto_matcher(std::ostream &os, const DFA &dfa,
+                        std::string_view name) {
+    const auto compiled = dfa.canonicalize().compile();
+    const auto state_count = compiled.get_state_count() - 1;
+
+    // Ranges of every state, and which states are jumped to, so that
+    // labels are only written where they are used
+    std::vector<std::vector<ByteRange>> state_ranges(state_count);
+    std::vector<bool> is_target(state_count, false);
+    for (std::size_t state = 1; state <= state_count; state++) {
+        auto &ranges = state_ranges[state - 1];
+        for (unsigned byte = 0; byte < 256; byte++) {
+            auto dest = compiled.next_state(state, static_cast<char>(byte));
+            if (!ranges.empty() && ranges.back().dest == dest) {
+                ranges.back().last = byte;
+            } else {
+                ranges.push_back({byte, byte, dest});
+            }
+            if (dest != CompiledDFA::dead_state) {
+                is_target[dest - 1] = true;
+            }
+        }
+    }
+
+    os << "// Generated by write_goto_matcher. Do not edit.\n"
+       << "#pragma once\n\n"
+       << "#include <string_view>\n\n"
+       << "inline bool " << name << "(std::string_view word) {\n"
+       << "    auto position = word.begin();\n"
+       << "    const auto end = word.end();\n";
+    // States with a single range jump without looking at the byte
+    auto is_branching = [](const auto &ranges) { return ranges.size() > 1; };
+    if (std::ranges::any_of(state_ranges, is_branching)) {
+        os << "    unsigned char symbol;\n";
+    }
+
+    // The initial state is 0, and comes first
+    for (std::size_t state = 0; state < state_count; state++) {
+        os << '\n';
+        if (is_target[state]) {
+            os << "state_" << state << ":\n";
+        }
+        const auto *is_final = compiled.is_final(state + 1) ? "true" : "false";
+        os << "    if (position == end) {\n"
+           << "        return " << is_final << ";\n"
+           << "    }\n";
+        const auto &ranges = state_ranges[state];
+        if (ranges.size() > 1) {
+            os << "    symbol = static_cast<unsigned char>(*position++);\n";
+        } else if (ranges.front().dest != CompiledDFA::dead_state) {
+            os << "    position++;\n";
+        }
+        write_range_tree(os, ranges, 1);
+    }
+
+    os << "}\n";
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+#include "dfa.hpp"
+
+/**
+ * Check if name can be used as a C++ identifier: it is a letter or
+ * underscore followed by letters, digits and underscores, and is not a
+ * keyword or alternative operator token like and.
+ */
+bool is_identifier(std::string_view name);
+
+/**
+ * Write a C++ header defining the DFA as an inline constexpr StaticDFA
+ * named name, see static_dfa.hpp. States are renumbered as by
+ * DFA::canonicalize, so minimal DFAs of equal languages give identical
+ * headers. Requires name to be a C++ identifier.
+ */
+void write_static_dfa_header(std::ostream &os, const DFA &dfa,
+                             std::string_view name);
+
+/**
+ * Write a C++ header defining the DFA as an inline function
+ * bool name(std::string_view word), which checks if the word is accepted.
+ * Each state is a block of code reached via goto, so that matching loads
+ * no tables, and the bytes of each state are split into ranges with the
+ * same destination, which are picked by a tree of comparisons. States are
+ * renumbered as by DFA::canonicalize. Meant for minimized DFAs, since the
+ * code grows with the state count. Requires name to be a C++ identifier.
+ */
+void write_goto_matcher(std::ostream &os, const DFA &dfa,
+                        std::string_view name);
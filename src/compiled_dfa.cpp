@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include "compiled_dfa.hpp"
+#include "dfa.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct Storage {
+    std::array<std::uint8_t, 256> byte_classes{};
+    std::vector<CompiledDFA::IndexType> table;
+    std::vector<CompiledDFA::WordType> final_bits;
+    std::vector<CompiledDFA::StateType> state_names;
+};
+
+constexpr std::uint32_t file_magic = 0x42414644; // "DFAB"
+constexpr std::uint32_t file_version = 1;
+
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t state_count;
+    std::uint32_t class_count;
+    std::uint32_t initial_state;
+    std::uint32_t reserved;
+    std::uint64_t checksum;
+};
+
+constexpr std::size_t align_to_word(std::size_t size) {
+    return (size + 7) / 8 * 8;
+}
+
+// Offsets of the sections following the header
+struct FileLayout {
+    std::size_t byte_classes;
+    std::size_t table;
+    std::size_t final_bits;
+    std::size_t state_names;
+    std::size_t end;
+
+    FileLayout(std::size_t state_count, std::size_t class_count) {
+        byte_classes = sizeof(FileHeader);
+        table = align_to_word(byte_classes + 256);
+        final_bits = align_to_word(
+            table + state_count * class_count * sizeof(CompiledDFA::IndexType));
+        state_names = align_to_word(
+            final_bits + (state_count + CompiledDFA::word_bits - 1) /
+                             CompiledDFA::word_bits *
+                             sizeof(CompiledDFA::WordType));
+        end = align_to_word(state_names +
+                            state_count * sizeof(CompiledDFA::StateType));
+    }
+};
+
+// FNV-1a
+class Checksum {
+private:
+    std::uint64_t hash = 0xcbf29ce484222325;
+
+public:
+    void update(const void *data, std::size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3;
+        }
+    }
+
+    [[nodiscard]] std::uint64_t get() const { return hash; }
+};
+
+// The mapping is page aligned, and every section is word aligned within it
+template <typename T>
+std::span<const T> view_section(std::string_view contents, std::size_t offset,
+                                std::size_t count) {
+    return {reinterpret_cast<const T *>(contents.data() + offset), count};
+}
+
+// Words matched at once by accepts_many
+constexpr std::size_t lane_count = 8;
+
+using LaneArray = std::array<CompiledDFA::IndexType, lane_count>;
+
+// Look up the next state of every lane: states[i] = table[indices[i]]
+struct ScalarStep {
+    void operator()(const CompiledDFA::IndexType *table,
+                    const LaneArray &indices, LaneArray &states) const {
+        for (std::size_t lane = 0; lane < lane_count; lane++) {
+            states[lane] = table[indices[lane]];
+        }
+    }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+struct GatherStep {
+    [[gnu::target("avx2")]] void operator()(const CompiledDFA::IndexType *table,
+                                            const LaneArray &indices,
+                                            LaneArray &states) const {
+        auto index_vector = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(indices.data()));
+        auto state_vector = _mm256_i32gather_epi32(
+            reinterpret_cast<const int *>(table), index_vector, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(states.data()),
+                            state_vector);
+    }
+};
+#endif
+
+struct LaneTables {
+    const CompiledDFA::IndexType *table;
+    const std::uint8_t *byte_classes;
+    std::size_t class_count;
+    CompiledDFA::IndexType initial_state;
+};
+
+/**
+ * Match words through lane_count interleaved lanes. Whenever a lane's word
+ * ends or reaches the dead state, the lane moves on to the next word.
+ */
+template <typename Step, typename IsFinalFn>
+[[gnu::always_inline]] inline void
+accept_lanes(const LaneTables &tables, IsFinalFn &&is_final,
+             std::span<const std::string_view> words,
+             std::vector<bool> &results, Step step) {
+    LaneArray states{};
+    LaneArray indices{};
+    std::array<std::size_t, lane_count> word_of{};
+    std::array<std::size_t, lane_count> position_of{};
+    std::array<bool, lane_count> is_active{};
+
+    // Give the lane the next word which takes at least one step
+    std::size_t next_word = 0;
+    auto refill = [&](std::size_t lane) {
+        while (next_word < words.size()) {
+            auto word = next_word++;
+            if (words[word].empty()) {
+                results[word] = is_final(tables.initial_state);
+                continue;
+            }
+
+            word_of[lane] = word;
+            position_of[lane] = 0;
+            states[lane] = tables.initial_state;
+            return true;
+        }
+        return false;
+    };
+
+    std::size_t active_count = 0;
+    for (std::size_t lane = 0; lane < lane_count; lane++) {
+        is_active[lane] = refill(lane);
+        active_count += is_active[lane];
+    }
+
+    while (active_count > 0) {
+        // Idle lanes look up the dead state's row, which is harmless
+        for (std::size_t lane = 0; lane < lane_count; lane++) {
+            indices[lane] = 0;
+            if (is_active[lane]) {
+                auto symbol = static_cast<unsigned char>(
+                    words[word_of[lane]][position_of[lane]]);
+                indices[lane] = states[lane] * tables.class_count +
+                                tables.byte_classes[symbol];
+            }
+        }
+
+        step(tables.table, indices, states);
+
+        for (std::size_t lane = 0; lane < lane_count; lane++) {
+            if (!is_active[lane]) {
+                continue;
+            }
+
+            auto position = ++position_of[lane];
+            auto word = word_of[lane];
+            if (states[lane] == CompiledDFA::dead_state) {
+                results[word] = false;
+            } else if (position == words[word].size()) {
+                results[word] = is_final(states[lane]);
+            } else {
+                continue;
+            }
+
+            is_active[lane] = refill(lane);
+            active_count -= !is_active[lane];
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <typename IsFinalFn>
+[[gnu::target("avx2")]] void
+accept_lanes_avx2(const LaneTables &tables, IsFinalFn &&is_final,
+                  std::span<const std::string_view> words,
+                  std::vector<bool> &results) {
+    accept_lanes(tables, is_final, words, results, GatherStep{});
+}
+#endif
+
+} // namespace
+
+CompiledDFA::CompiledDFA(const DFA &dfa) {
+    AUTOMATA_STATS_PHASE(compilation);
+    auto storage = std::make_shared<Storage>();
+    auto &names = storage->state_names;
+
+    // Keep the graph's numbering, shifted by one to leave index 0 for the
+    // dead state.
+    const auto &graph = dfa.get_frozen_graph();
+    names.push_back(0);
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        names.push_back(graph.get_state_name(state));
+    }
+    initial_state = graph.find_state(dfa.initial_state) + 1;
+    state_count = names.size();
+
+    // Bytes with identical columns share a class. Columns are never built:
+    // instead, all bytes start in one block, which the edges of every state
+    // split by destination. A group of bytes which covers its whole block
+    // stays in it, so blocks never become empty.
+    std::array<std::uint16_t, 256> blocks{};
+    std::array<std::uint16_t, 256> block_sizes{256};
+    std::uint16_t block_count = 1;
+    std::array<bool, 256> has_edges{};
+    // (block, dest, byte) of the current state's edges
+    std::vector<std::array<IndexType, 3>> groups;
+    // Once the blocks are fine enough, most states split none of them. A
+    // state does if some block is only partly covered by its edges, or
+    // covered with several destinations.
+    std::array<IndexType, 256> block_dests;
+    std::array<std::uint16_t, 256> block_edge_counts{};
+    std::array<std::uint16_t, 256> touched_blocks;
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        auto edges = graph.get_edges(state);
+        std::size_t touched_count = 0;
+        bool splits = false;
+        for (auto edge : edges) {
+            has_edges[edge.symbol] = true;
+            auto block = blocks[edge.symbol];
+            if (block_edge_counts[block] == 0) {
+                touched_blocks[touched_count++] = block;
+                block_dests[block] = edge.dest;
+            } else if (block_dests[block] != edge.dest) {
+                splits = true;
+            }
+            block_edge_counts[block]++;
+        }
+        for (std::size_t i = 0; i < touched_count; i++) {
+            auto block = touched_blocks[i];
+            splits = splits || block_edge_counts[block] != block_sizes[block];
+            block_edge_counts[block] = 0;
+        }
+        if (!splits) {
+            continue;
+        }
+
+        groups.clear();
+        for (auto edge : edges) {
+            groups.push_back({blocks[edge.symbol], edge.dest, edge.symbol});
+        }
+        std::ranges::sort(groups);
+
+        for (auto begin = groups.begin(); begin != groups.end();) {
+            auto end = std::find_if(begin, groups.end(), [&](const auto &item) {
+                return item[0] != (*begin)[0] || item[1] != (*begin)[1];
+            });
+            auto block = (*begin)[0];
+            auto size = static_cast<std::uint16_t>(end - begin);
+            if (size != block_sizes[block]) {
+                block_sizes[block] -= size;
+                block_sizes[block_count] = size;
+                for (auto it = begin; it != end; it++) {
+                    blocks[(*it)[2]] = block_count;
+                }
+                block_count++;
+            }
+            begin = end;
+        }
+    }
+
+    // The bytes without edges form one block, whose column is all dead. It
+    // becomes class 0, and the other blocks are numbered in byte order.
+    constexpr std::uint16_t no_class = UINT16_MAX;
+    std::array<std::uint16_t, 256> block_classes;
+    block_classes.fill(no_class);
+    class_count = 0;
+    for (std::size_t byte = 0; byte < 256; byte++) {
+        if (!has_edges[byte]) {
+            block_classes[blocks[byte]] = 0;
+            class_count = 1;
+            break;
+        }
+    }
+    for (std::size_t byte = 0; byte < 256; byte++) {
+        auto &byte_class = block_classes[blocks[byte]];
+        if (byte_class == no_class) {
+            byte_class = class_count++;
+        }
+        storage->byte_classes[byte] = byte_class;
+    }
+
+    auto &transitions = storage->table;
+    transitions.assign(state_count * class_count, dead_state);
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        for (auto edge : graph.get_edges(state)) {
+            auto byte_class = storage->byte_classes[edge.symbol];
+            transitions[(state + 1) * class_count + byte_class] = edge.dest + 1;
+        }
+    }
+
+    storage->final_bits.assign((state_count + word_bits - 1) / word_bits, 0);
+    for (auto state : dfa.final_states) {
+        auto index = graph.find_state(state);
+        if (index != TransitionGraph::no_state) {
+            storage->final_bits[(index + 1) / word_bits] |=
+                WordType(1) << ((index + 1) % word_bits);
+        }
+    }
+
+    byte_classes = storage->byte_classes.data();
+    table = storage->table;
+    final_bits = storage->final_bits;
+    state_names = storage->state_names;
+    owner = std::move(storage);
+}
+
+void CompiledDFA::save(std::ostream &os) const {
+    FileLayout layout(state_count, class_count);
+
+    // Assemble the sections after the header, with zero padding
+    std::string payload(layout.end - layout.byte_classes, '\0');
+    auto write_section = [&](std::size_t offset, const void *data,
+                             std::size_t size) {
+        std::memcpy(payload.data() + offset - layout.byte_classes, data, size);
+    };
+    write_section(layout.byte_classes, byte_classes, 256);
+    write_section(layout.table, table.data(), table.size_bytes());
+    write_section(layout.final_bits, final_bits.data(),
+                  final_bits.size_bytes());
+    write_section(layout.state_names, state_names.data(),
+                  state_names.size_bytes());
+
+    Checksum checksum;
+    checksum.update(payload.data(), payload.size());
+
+    FileHeader header{};
+    header.magic = file_magic;
+    header.version = file_version;
+    header.state_count = state_count;
+    header.class_count = class_count;
+    header.initial_state = initial_state;
+    header.checksum = checksum.get();
+
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(payload.data(), payload.size());
+}
+
+CompiledDFA CompiledDFA::load(const std::string &path, bool verify_checksum) {
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Access::random);
+    auto contents = file->get_contents();
+
+    FileHeader header;
+    if (contents.size() < sizeof(header)) {
+        throw std::runtime_error(path + ": truncated compiled DFA");
+    }
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (header.magic != file_magic) {
+        throw std::runtime_error(path + ": not a compiled DFA");
+    }
+    if (header.version != file_version) {
+        throw std::runtime_error(path + ": unsupported compiled DFA version");
+    }
+
+    if (header.class_count == 0 || header.class_count > 256 ||
+        header.initial_state >= header.state_count) {
+        throw std::runtime_error(path + ": invalid compiled DFA header");
+    }
+    FileLayout layout(header.state_count, header.class_count);
+    if (contents.size() < layout.end) {
+        throw std::runtime_error(path + ": truncated compiled DFA");
+    }
+
+    if (verify_checksum) {
+        Checksum checksum;
+        checksum.update(contents.data() + layout.byte_classes,
+                        layout.end - layout.byte_classes);
+        if (checksum.get() != header.checksum) {
+            throw std::runtime_error(path + ": compiled DFA checksum mismatch");
+        }
+    }
+
+    CompiledDFA compiled;
+    compiled.state_count = header.state_count;
+    compiled.class_count = header.class_count;
+    compiled.initial_state = header.initial_state;
+    compiled.byte_classes = reinterpret_cast<const std::uint8_t *>(
+        contents.data() + layout.byte_classes);
+    compiled.table = view_section<IndexType>(
+        contents, layout.table, compiled.state_count * compiled.class_count);
+    compiled.final_bits = view_section<WordType>(
+        contents, layout.final_bits,
+        (compiled.state_count + word_bits - 1) / word_bits);
+    compiled.state_names = view_section<StateType>(
+        contents, layout.state_names, compiled.state_count);
+    compiled.owner = std::move(file);
+
+    // Matching indexes the tables with these values unchecked, so they are
+    // checked here whether or not the checksum is
+    for (int byte = 0; byte < 256; byte++) {
+        if (compiled.byte_classes[byte] >= compiled.class_count) {
+            throw std::runtime_error(path + ": byte class out of range");
+        }
+    }
+    for (auto dest : compiled.table) {
+        if (dest >= compiled.state_count) {
+            throw std::runtime_error(path + ": state out of range");
+        }
+    }
+
+    return compiled;
+}
+
+bool CompiledDFA::accepts(std::string_view word) const {
+    auto state = initial_state;
+    for (auto symbol : word) {
+        state = next_state(state, symbol);
+        if (state == dead_state) {
+            return false;
+        }
+    }
+
+    return is_final(state);
+}
+
+std::vector<bool>
+CompiledDFA::accepts_many(std::span<const std::string_view> words) const {
+    std::vector<bool> results(words.size());
+
+    LaneTables tables{table.data(), byte_classes, class_count, initial_state};
+    auto is_final = [this](IndexType state) { return this->is_final(state); };
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Gathers take signed 32-bit indices
+    if (__builtin_cpu_supports("avx2") && table.size() <= INT32_MAX) {
+        accept_lanes_avx2(tables, is_final, words, results);
+        return results;
+    }
+#endif
+
+    accept_lanes(tables, is_final, words, results, ScalarStep{});
+    return results;
+}
+
+std::optional<std::vector<CompiledDFA::StateType>>
+CompiledDFA::verify_word(std::string_view word) const {
+    std::vector<StateType> chain;
+    chain.reserve(word.size() + 1);
+
+    auto state = initial_state;
+    chain.push_back(state_names[state]);
+
+    for (auto symbol : word) {
+        state = next_state(state, symbol);
+        if (state == dead_state) {
+            return {};
+        }
+        chain.push_back(state_names[state]);
+    }
+
+    if (is_final(state)) {
+        return chain;
+    }
+
+    return {};
+}
+
+void CompiledDFA::Matcher::feed(std::span<const char> chunk) {
+    for (auto symbol : chunk) {
+        if (state == dead_state) {
+            return;
+        }
+        state = dfa->next_state(state, symbol);
+    }
+}
+
+bool CompiledDFA::Matcher::finish() {
+    auto is_accepted = is_accepting();
+    state = dfa->initial_state;
+    return is_accepted;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "automaton.hpp"
+
+class DFA;
+
+/**
+ * A DFA compiled into a dense, row-major transition table.
+ *
+ * States are renumbered to 0..N-1, where state 0 is an explicit dead state
+ * that every missing transition leads to. Input bytes are first mapped to
+ * byte classes, so that each row only has one column per class.
+ *
+ * The tables are immutable and shared between copies. They are either built
+ * from a DFA, or viewed directly inside a memory-mapped binary file written
+ * by save().
+ */
+class CompiledDFA {
+public:
+    using StateType = Automaton::StateType;
+    using IndexType = std::uint32_t;
+    using WordType = std::uint64_t;
+
+    static constexpr IndexType dead_state = 0;
+    static constexpr std::size_t word_bits = 64;
+
+    /**
+     * Matches input arriving in chunks, without buffering it. The matcher
+     * borrows the compiled DFA, and its whole state is one state index, so
+     * it can be copied or saved and restored freely.
+     */
+    class Matcher {
+    public:
+        using Snapshot = IndexType;
+
+    private:
+        const CompiledDFA *dfa;
+        IndexType state;
+
+    public:
+        explicit Matcher(const CompiledDFA &dfa)
+            : dfa(&dfa), state(dfa.initial_state) {}
+
+        /** Continue matching with the next chunk of input. */
+        void feed(std::span<const char> chunk);
+
+        [[nodiscard]] bool is_accepting() const { return dfa->is_final(state); }
+        /** True if no continuation of the input can be accepted. */
+        [[nodiscard]] bool is_dead() const { return state == dead_state; }
+
+        /**
+         * End the input. Returns whether all input fed so far is accepted,
+         * and starts over for the next input.
+         */
+        bool finish();
+
+        [[nodiscard]] Snapshot save() const { return state; }
+        void restore(Snapshot snapshot) { state = snapshot; }
+    };
+
+private:
+    // Keeps the tables alive: either owned storage or a file mapping
+    std::shared_ptr<const void> owner;
+
+    const std::uint8_t *byte_classes = nullptr;
+    std::size_t class_count = 1;
+    std::size_t state_count = 1;
+    IndexType initial_state = dead_state;
+
+    std::span<const IndexType> table;
+    std::span<const WordType> final_bits;
+    // Original name of every state. The dead state has no name.
+    std::span<const StateType> state_names;
+
+    CompiledDFA() = default;
+
+public:
+    explicit CompiledDFA(const DFA &dfa);
+
+    /**
+     * Write the tables in binary form, in native byte order:
+     * a header with a magic number, format version, state count, class
+     * count, initial state and a checksum of the rest, then the byte class
+     * map, the transition table, the final state bitmap and the state names.
+     * Every section starts at a multiple of 8 bytes.
+     */
+    void save(std::ostream &os) const;
+
+    /**
+     * Map a file written by save() and view the tables inside it, without
+     * parsing or copying them. Every table entry is range checked once.
+     * Throws std::runtime_error if the file is not a valid compiled DFA, or
+     * if verify_checksum is set and its contents were changed.
+     */
+    static CompiledDFA load(const std::string &path,
+                            bool verify_checksum = true);
+
+    [[nodiscard]] IndexType get_initial_state() const { return initial_state; }
+    [[nodiscard]] std::size_t get_state_count() const { return state_count; }
+    [[nodiscard]] std::size_t get_class_count() const { return class_count; }
+
+    /** Symbols of the same class lead to the same state from every state. */
+    [[nodiscard]] std::uint8_t get_byte_class(char symbol) const {
+        return byte_classes[static_cast<unsigned char>(symbol)];
+    }
+
+    [[nodiscard]] IndexType next_state(IndexType state, char symbol) const {
+        auto byte_class = byte_classes[static_cast<unsigned char>(symbol)];
+        return table[state * class_count + byte_class];
+    }
+
+    [[nodiscard]] bool is_final(IndexType state) const {
+        return (final_bits[state / word_bits] >> (state % word_bits)) & 1;
+    }
+
+    [[nodiscard]] StateType get_state_name(IndexType state) const {
+        return state_names[state];
+    }
+
+    /** Check if the word is accepted, without building a state chain. */
+    [[nodiscard]] bool accepts(std::string_view word) const;
+
+    /**
+     * Check many independent words at once. Several words are interleaved
+     * through the table, so that their lookups overlap, using AVX2 gathers
+     * where the CPU supports them. Words leave early when they reach the
+     * dead state.
+     */
+    [[nodiscard]] std::vector<bool>
+    accepts_many(std::span<const std::string_view> words) const;
+
+    /** Same as DFA::verify_word, in terms of the original state names. */
+    [[nodiscard]] std::optional<std::vector<StateType>>
+    verify_word(std::string_view word) const;
+};
@@ -1,71 +1,86 @@
 #include <algorithm>
+#include <array>
 #include <cstddef>
-#include <fstream>
+#include <cstdint>
 #include <istream>
-#include <iterator>
 #include <numeric>
 #include <ostream>
 #include <queue>
-#include <set>
-#include <stdexcept>
-#include <unordered_map>
+#include <span>
 #include <unordered_set>
 
 #include "dfa.hpp"
+#include "language_checks.hpp"
+#include "product_construction.hpp"
+#include "stats.hpp"
 #include "utils.hpp"
 
-void DFA::add_state(StateType state) { transition_map[state] = SymbolMap(); }
+void DFA::invalidate_caches() { compiled.reset(); }
+
+void DFA::add_state(StateType state) {
+    transition_graph.add_state(state);
+    invalidate_caches();
+}
 
 void DFA::add_transition(StateType src_state, StateType dest_state,
                          SymbolType symbol) {
-    transition_map[src_state][symbol] = dest_state;
+    transition_graph.add_transition(src_state, dest_state,
+                                    TransitionGraph::to_symbol(symbol));
+    invalidate_caches();
 }
 
-std::optional<std::vector<DFA::StateType>>
-DFA::verify_word(const std::string &word) {
-    std::vector<StateType> chain;
+CompiledDFA DFA::compile() const { return CompiledDFA(*this); }
 
-    auto current_state = initial_state;
-    chain.push_back(current_state);
-
-    for (auto symbol : word) {
-        try {
-            current_state = transition_map.at(current_state).at(symbol);
-            chain.push_back(current_state);
-        } catch (std::out_of_range &exception) {
-            return {};
-        }
+const CompiledDFA &DFA::get_compiled() {
+    if (!compiled) {
+        freeze();
+        compiled = std::make_shared<const CompiledDFA>(*this);
     }
+    return *compiled;
+}
 
-    if (final_states.contains(current_state)) {
-        return chain;
-    }
+CompiledDFA::Matcher DFA::create_matcher() {
+    return CompiledDFA::Matcher(get_compiled());
+}
+
+std::optional<std::vector<DFA::StateType>>
+DFA::verify_word(const std::string &word) {
+    return get_compiled().verify_word(word);
+}
 
-    return {};
+bool DFA::accepts(std::string_view word) {
+    return get_compiled().accepts(word);
+}
+
+std::vector<bool> DFA::accepts_many(std::span<const std::string_view> words) {
+    return get_compiled().accepts_many(words);
 }
 
 std::unordered_set<DFA::StateType> DFA::get_unreachable_states() const {
-    std::unordered_set<StateType> reachable_states{initial_state};
+    const auto &graph = get_frozen_graph();
+    std::vector<bool> is_reachable(graph.get_state_count(), false);
 
-    std::queue<StateType> state_queue;
-    state_queue.push(initial_state);
+    std::queue<TransitionGraph::IndexType> state_queue;
+    auto initial_index = graph.find_state(initial_state);
+    is_reachable[initial_index] = true;
+    state_queue.push(initial_index);
 
     while (!state_queue.empty()) {
         auto state = state_queue.front();
         state_queue.pop();
 
-        for (auto [symbol, dest_state] : transition_map.at(state)) {
-            auto was_inserted = reachable_states.insert(dest_state).second;
-            if (was_inserted) {
-                state_queue.push(dest_state);
+        for (auto edge : graph.get_edges(state)) {
+            if (!is_reachable[edge.dest]) {
+                is_reachable[edge.dest] = true;
+                state_queue.push(edge.dest);
             }
         }
     }
 
     std::unordered_set<StateType> unreachable_states;
-    for (auto state_pair : transition_map) {
-        if (!reachable_states.contains(state_pair.first)) {
-            unreachable_states.insert(state_pair.first);
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        if (!is_reachable[state]) {
+            unreachable_states.insert(graph.get_state_name(state));
         }
     }
 
@@ -73,190 +88,464 @@ std::unordered_set<DFA::StateType> DFA::get_unreachable_states() const {
 }
 
 std::vector<DFA::SymbolType> DFA::get_alphabet() const {
-    std::unordered_set<SymbolType> symbols;
-
-    for (auto src_pair : transition_map) {
-        for (auto transition_pair : src_pair.second) {
-            symbols.insert(transition_pair.first);
+    const auto &graph = get_frozen_graph();
+    std::array<bool, 256> is_used{};
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        for (auto edge : graph.get_edges(state)) {
+            is_used[edge.symbol] = true;
         }
     }
 
-    std::vector<SymbolType> alphabet(symbols.begin(), symbols.end());
+    std::vector<SymbolType> alphabet;
+    for (std::size_t symbol = 0; symbol < is_used.size(); symbol++) {
+        if (is_used[symbol]) {
+            alphabet.push_back(TransitionGraph::to_char(symbol));
+        }
+    }
     return alphabet;
 }
 
+namespace {
+
+/**
+ * A partition of the states 0..N-1 into blocks. The states of every block are
+ * contiguous in a permutation array, so that splitting a block only moves
+ * states around inside it.
+ */
+class Partition {
+private:
+    std::vector<std::uint32_t> elements;
+    std::vector<std::uint32_t> location_of;
+    std::vector<std::uint32_t> block_of;
+
+    std::vector<std::uint32_t> block_begin;
+    std::vector<std::uint32_t> block_end;
+    // Marked states are moved to the front of their block
+    std::vector<std::uint32_t> marked_count;
+    std::vector<std::uint32_t> touched_blocks;
+
+public:
+    explicit Partition(std::size_t state_count)
+        : elements(state_count), location_of(state_count),
+          block_of(state_count, 0) {
+        std::iota(elements.begin(), elements.end(), 0);
+        std::iota(location_of.begin(), location_of.end(), 0);
+        block_begin.push_back(0);
+        block_end.push_back(state_count);
+        marked_count.push_back(0);
+    }
+
+    [[nodiscard]] std::size_t get_block_count() const {
+        return block_begin.size();
+    }
+    [[nodiscard]] std::uint32_t get_block(std::uint32_t state) const {
+        return block_of[state];
+    }
+    [[nodiscard]] std::size_t get_block_size(std::uint32_t block) const {
+        return block_end[block] - block_begin[block];
+    }
+    [[nodiscard]] std::span<const std::uint32_t>
+    get_states(std::uint32_t block) const {
+        return {elements.data() + block_begin[block], get_block_size(block)};
+    }
+
+    void mark(std::uint32_t state) {
+        auto block = block_of[state];
+        auto marked_location = block_begin[block] + marked_count[block];
+        if (location_of[state] < marked_location) {
+            // Already marked
+            return;
+        }
+        if (marked_count[block] == 0) {
+            touched_blocks.push_back(block);
+        }
+
+        // Swap the state with the first unmarked state of its block
+        auto other_state = elements[marked_location];
+        std::swap(elements[location_of[state]], elements[marked_location]);
+        location_of[other_state] = location_of[state];
+        location_of[state] = marked_location;
+        marked_count[block]++;
+    }
+
+    /**
+     * Split every block with marked states into its marked and unmarked
+     * states, and clear the marks. Calls on_split(old_block, new_block) for
+     * every split, where the new block holds the marked states.
+     */
+    template <typename Fn> void split_marked(Fn &&on_split) {
+        for (auto block : touched_blocks) {
+            auto split_location = block_begin[block] + marked_count[block];
+            marked_count[block] = 0;
+            if (split_location == block_end[block]) {
+                // Every state is marked, nothing to split
+                continue;
+            }
+
+            AUTOMATA_STATS_ADD(hopcroft_splits, 1);
+            std::uint32_t new_block = block_begin.size();
+            block_begin.push_back(block_begin[block]);
+            block_end.push_back(split_location);
+            marked_count.push_back(0);
+            block_begin[block] = split_location;
+
+            for (auto state : get_states(new_block)) {
+                block_of[state] = new_block;
+            }
+
+            on_split(block, new_block);
+        }
+        touched_blocks.clear();
+    }
+};
+
+} // namespace
+
 DFA DFA::minimize() const {
-    const auto unreachable_states = get_unreachable_states();
+    using IndexType = std::uint32_t;
+    AUTOMATA_STATS_PHASE(minimization);
+
+    const auto &graph = get_frozen_graph();
     const auto alphabet = get_alphabet();
+    const auto symbol_count = alphabet.size();
+    std::array<IndexType, 256> symbol_indices{};
+    for (std::size_t symbol = 0; symbol < symbol_count; symbol++) {
+        symbol_indices[TransitionGraph::to_symbol(alphabet[symbol])] = symbol;
+    }
 
-    using Set = std::set<StateType>;
-    using Partitions = std::set<Set>;
-    Partitions partitions;
-    Partitions w;
+    // Renumber reachable states in BFS order, and add a sink state which all
+    // missing transitions go to, so that the DFA is complete. Sink states
+    // are numbered once all states are known.
+    std::vector<StateType> state_names{initial_state};
+    std::vector<IndexType> index_of(graph.get_state_count(), UINT32_MAX);
+    std::vector<IndexType> graph_indices{graph.find_state(initial_state)};
+    index_of[graph_indices.front()] = 0;
+    std::vector<IndexType> transitions;
+    for (std::size_t state = 0; state < state_names.size(); state++) {
+        transitions.resize(transitions.size() + symbol_count, UINT32_MAX);
+        auto *row = transitions.data() + state * symbol_count;
+        for (auto edge : graph.get_edges(graph_indices[state])) {
+            auto &dest_index = index_of[edge.dest];
+            if (dest_index == UINT32_MAX) {
+                dest_index = state_names.size();
+                state_names.push_back(graph.get_state_name(edge.dest));
+                graph_indices.push_back(edge.dest);
+            }
+            row[symbol_indices[edge.symbol]] = dest_index;
+        }
+    }
+    const IndexType sink_state = state_names.size();
+    const std::size_t state_count = state_names.size() + 1;
+    std::ranges::replace(transitions, UINT32_MAX, sink_state);
+    transitions.resize(state_count * symbol_count, sink_state);
+
+    // Inverse transitions for every symbol, as consecutive lists of source
+    // states per (symbol, destination state).
+    std::vector<IndexType> inverse_begin(symbol_count * state_count + 1, 0);
+    for (std::size_t src = 0; src < state_count; src++) {
+        for (std::size_t symbol = 0; symbol < symbol_count; symbol++) {
+            auto dest = transitions[src * symbol_count + symbol];
+            inverse_begin[symbol * state_count + dest + 1]++;
+        }
+    }
+    std::partial_sum(inverse_begin.begin(), inverse_begin.end(),
+                     inverse_begin.begin());
+    std::vector<IndexType> inverse_sources(inverse_begin.back());
+    {
+        auto next_slot = inverse_begin;
+        for (std::size_t src = 0; src < state_count; src++) {
+            for (std::size_t symbol = 0; symbol < symbol_count; symbol++) {
+                auto dest = transitions[src * symbol_count + symbol];
+                inverse_sources[next_slot[symbol * state_count + dest]++] =
+                    src;
+            }
+        }
+    }
 
     // First, partition into final states and non final states.
-    Set final_states_set;
-    Set non_final_states;
-    for (auto state_pair : transition_map) {
-        if (unreachable_states.contains(state_pair.first)) {
-            continue;
+    Partition partition(state_count);
+    for (std::size_t state = 0; state < sink_state; state++) {
+        if (final_states.contains(state_names[state])) {
+            partition.mark(state);
         }
+    }
 
-        if (final_states.contains(state_pair.first)) {
-            final_states_set.insert(state_pair.first);
-        } else {
-            non_final_states.insert(state_pair.first);
+    // Worklist of (block, symbol) splitters
+    std::vector<std::pair<IndexType, IndexType>> worklist;
+    std::vector<bool> is_in_worklist;
+    auto add_splitter = [&](IndexType block, IndexType symbol) {
+        auto index = block * symbol_count + symbol;
+        if (is_in_worklist.size() <= index) {
+            is_in_worklist.resize((block + 1) * symbol_count, false);
+        }
+        if (!is_in_worklist[index]) {
+            is_in_worklist[index] = true;
+            worklist.emplace_back(block, symbol);
+            AUTOMATA_STATS_MAX(hopcroft_worklist_peak, worklist.size());
+        }
+    };
+
+    auto on_split = [&](IndexType old_block, IndexType new_block) {
+        // If the old block is still waiting to be used as a splitter, both
+        // halves have to be used. Otherwise the smaller half is enough.
+        auto smaller_block =
+            partition.get_block_size(new_block) <=
+                    partition.get_block_size(old_block)
+                ? new_block
+                : old_block;
+        for (IndexType symbol = 0; symbol < symbol_count; symbol++) {
+            auto index = old_block * symbol_count + symbol;
+            if (index < is_in_worklist.size() && is_in_worklist[index]) {
+                add_splitter(new_block, symbol);
+            } else {
+                add_splitter(smaller_block, symbol);
+            }
+        }
+    };
+    partition.split_marked(on_split);
+    if (partition.get_block_count() == 1) {
+        for (IndexType symbol = 0; symbol < symbol_count; symbol++) {
+            add_splitter(0, symbol);
         }
     }
-    partitions.insert(final_states_set);
-    partitions.insert(non_final_states);
-    w.insert(final_states_set);
-    w.insert(non_final_states);
 
     // Hopcroft's algorithm
-    while (!w.empty()) {
-        const Set &a = *w.begin();
-
-        for (auto symbol : alphabet) {
-            Set x;
-            for (const auto &[src_state, symbol_map] : transition_map) {
-                if (unreachable_states.contains(src_state)) {
-                    continue;
-                }
-
-                auto dest_iter = symbol_map.find(symbol);
-                if (dest_iter != symbol_map.end() &&
-                    a.contains(dest_iter->second)) {
-                    x.insert(src_state);
-                }
-            }
-
-            for (auto y_iter = partitions.begin();
-                 y_iter != partitions.end();) {
-                const auto &y = *y_iter;
-
-                Set x_intersect_y;
-                std::ranges::set_intersection(
-                    x, y, std::inserter(x_intersect_y, x_intersect_y.begin()));
-
-                Set y_minus_x;
-                std::ranges::set_difference(
-                    y, x, std::inserter(y_minus_x, y_minus_x.begin()));
-
-                if (!x_intersect_y.empty() && !y_minus_x.empty()) {
-                    // Replace y with the intersection and the difference
-                    partitions.insert(x_intersect_y);
-                    partitions.insert(y_minus_x);
-
-                    // If y is in w, replace it there as well
-                    // Otherwise insert the smaller set of the two
-                    auto y_in_w_iter = w.find(y);
-                    if (y_in_w_iter != w.end()) {
-                        w.erase(y_in_w_iter);
-                        w.insert(x_intersect_y);
-                        w.insert(y_minus_x);
-                    } else {
-                        if (x_intersect_y.size() <= y_minus_x.size()) {
-                            w.insert(x_intersect_y);
-                        } else {
-                            w.insert(y_minus_x);
-                        }
-                    }
-
-                    y_iter = partitions.erase(y_iter);
-                } else {
-                    std::advance(y_iter, 1);
-                }
+    std::vector<IndexType> splitter_states;
+    while (!worklist.empty()) {
+        auto [splitter, symbol] = worklist.back();
+        worklist.pop_back();
+        AUTOMATA_STATS_ADD(hopcroft_splitters, 1);
+        is_in_worklist[splitter * symbol_count + symbol] = false;
+
+        // Mark every state which goes into the splitter via the symbol. The
+        // splitter's states are copied, since marking may reorder them.
+        auto states = partition.get_states(splitter);
+        splitter_states.assign(states.begin(), states.end());
+        for (auto dest : splitter_states) {
+            auto begin = inverse_begin[symbol * state_count + dest];
+            auto end = inverse_begin[symbol * state_count + dest + 1];
+            for (auto i = begin; i < end; i++) {
+                partition.mark(inverse_sources[i]);
             }
         }
 
-        w.erase(w.begin());
+        partition.split_marked(on_split);
     }
 
-    // Hopcroft finished, build minimized DFA from the partitions.
+    // Hopcroft finished, build minimized DFA from the blocks. The sink's
+    // block holds the states from which no final state is reachable, so it is
+    // dropped, along with transitions into it.
     DFA minimized;
 
-    std::vector<Set> partitions_vec(partitions.begin(), partitions.end());
-    std::unordered_map<StateType, StateType> original_state_to_partition;
+    const auto sink_block = partition.get_block(sink_state);
+    std::vector<StateType> block_to_state(partition.get_block_count(), -1);
+    StateType available_state_name = 0;
+    for (std::size_t state = 0; state < sink_state; state++) {
+        auto block = partition.get_block(state);
+        if (block != sink_block && block_to_state[block] == -1) {
+            block_to_state[block] = available_state_name++;
+            minimized.add_state(block_to_state[block]);
+            if (final_states.contains(state_names[state])) {
+                minimized.add_final_state(block_to_state[block]);
+            }
+        }
+    }
 
-    // Add new states to the minimized DFA
-    for (std::size_t i = 0; i < partitions_vec.size(); i++) {
-        const auto &p = partitions_vec[i];
+    if (partition.get_block(0) == sink_block) {
+        // The language is empty
+        minimized.add_state(0);
+        minimized.initial_state = 0;
+        minimized.freeze();
+        return minimized;
+    }
+    minimized.initial_state = block_to_state[partition.get_block(0)];
 
-        StateType new_state = i;
-        minimized.add_state(new_state);
+    // Add transitions from one representative of every block
+    for (std::size_t block = 0; block < partition.get_block_count();
+         block++) {
+        if (block == sink_block) {
+            continue;
+        }
 
-        for (auto state : p) {
-            original_state_to_partition[state] = new_state;
+        auto representative = partition.get_states(block).front();
+        for (std::size_t symbol = 0; symbol < symbol_count; symbol++) {
+            auto dest_block = partition.get_block(
+                transitions[representative * symbol_count + symbol]);
+            if (dest_block != sink_block) {
+                minimized.add_transition(block_to_state[block],
+                                         block_to_state[dest_block],
+                                         alphabet[symbol]);
+            }
         }
+    }
+
+    minimized.freeze();
+    return minimized;
+}
 
-        if (p.contains(initial_state)) {
-            minimized.initial_state = new_state;
+DFA DFA::canonicalize() const {
+    const auto &graph = get_frozen_graph();
+    DFA canonical;
+
+    // Edges are sorted by symbol, so following them in order is enough
+    std::vector<StateType> state_names(graph.get_state_count(), -1);
+    std::vector<TransitionGraph::IndexType> graph_indices{
+        graph.find_state(initial_state)};
+    state_names[graph_indices.front()] = 0;
+    canonical.set_initial_state(0);
+    for (std::size_t i = 0; i < graph_indices.size(); i++) {
+        auto state = graph_indices[i];
+        if (final_states.contains(graph.get_state_name(state))) {
+            canonical.add_final_state(i);
         }
 
-        if (final_states.contains(*p.begin())) {
-            minimized.add_final_state(new_state);
+        for (auto edge : graph.get_edges(state)) {
+            if (state_names[edge.dest] == -1) {
+                state_names[edge.dest] = graph_indices.size();
+                canonical.add_state(graph_indices.size());
+                graph_indices.push_back(edge.dest);
+            }
+            canonical.add_transition(i, state_names[edge.dest],
+                                     TransitionGraph::to_char(edge.symbol));
         }
     }
 
-    // Add transitions to the minimized DFA
-    for (std::size_t src_partition_name = 0;
-         src_partition_name < partitions_vec.size(); src_partition_name++) {
-        const auto &p = partitions_vec[src_partition_name];
-        for (auto state : p) {
-            for (const auto &[symbol, original_dest_state] :
-                 transition_map.at(state)) {
-                auto dest_partition_name =
-                    original_state_to_partition[original_dest_state];
-                minimized.add_transition(src_partition_name,
-                                         dest_partition_name, symbol);
-            }
+    canonical.freeze();
+    return canonical;
+}
+
+Fingerprint DFA::fingerprint() const {
+    return minimize().fingerprint_minimized();
+}
+
+Fingerprint DFA::fingerprint_minimized() const {
+    const auto &graph = get_frozen_graph();
+
+    // The minimized states are named by their graph indices, and the
+    // initial state is 0
+    FingerprintBuilder builder;
+    builder.add(graph.get_state_count());
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        auto edges = graph.get_edges(state);
+        builder.add(final_states.contains(state));
+        builder.add(edges.size());
+        for (auto edge : edges) {
+            builder.add(std::uint64_t(edge.symbol) << 32 | edge.dest);
         }
     }
+    return builder.finish();
+}
 
-    return minimized;
+DFA DFA::intersect(const DFA &other) const {
+    return build_product_dfa(*this, other, ProductOperation::intersect);
 }
 
-std::istream &operator>>(std::istream &is, DFA &dfa) {
-    std::size_t state_count;
+DFA DFA::unite(const DFA &other) const {
+    return build_product_dfa(*this, other, ProductOperation::unite);
+}
+
+DFA DFA::subtract(const DFA &other) const {
+    return build_product_dfa(*this, other, ProductOperation::subtract);
+}
+
+DFA DFA::symmetric_difference(const DFA &other) const {
+    return build_product_dfa(*this, other,
+                             ProductOperation::symmetric_difference);
+}
+
+DFA DFA::complement(std::span<const SymbolType> alphabet) const {
+    return build_complement_dfa(*this, alphabet);
+}
+
+DFA DFA::complement() const { return complement(get_alphabet()); }
+
+bool DFA::equivalent(const DFA &other) const {
+    return are_equivalent(compile(), other.compile());
+}
+
+std::optional<std::string> DFA::find_difference(const DFA &other) const {
+    return ::find_difference(compile(), other.compile());
+}
+
+bool DFA::is_subset_of(const DFA &other) const {
+    return !find_inclusion_counterexample(other).has_value();
+}
+
+std::optional<std::string>
+DFA::find_inclusion_counterexample(const DFA &other) const {
+    return ::find_inclusion_counterexample(compile(), other.compile());
+}
+
+template <typename Input>
+static Input &read_dfa(Input &is, DFA &dfa) {
+    AUTOMATA_STATS_PHASE(parse);
+    std::size_t state_count = 0;
     is >> state_count;
     for (std::size_t i = 0; i < state_count; i++) {
         DFA::StateType state;
-        is >> state;
+        if (!(is >> state)) {
+            break;
+        }
         dfa.add_state(state);
     }
 
-    std::size_t transition_count;
+    std::size_t transition_count = 0;
     is >> transition_count;
     for (std::size_t i = 0; i < transition_count; i++) {
         DFA::StateType src_state, dest_state;
         char symbol;
-        is >> src_state >> dest_state >> symbol;
+        if (!(is >> src_state >> dest_state >> symbol)) {
+            break;
+        }
         dfa.add_transition(src_state, dest_state, symbol);
     }
 
-    DFA::StateType initial_state;
+    DFA::StateType initial_state = 0;
     is >> initial_state;
     dfa.set_initial_state(initial_state);
 
-    std::size_t final_state_count;
+    std::size_t final_state_count = 0;
     is >> final_state_count;
     for (std::size_t i = 0; i < final_state_count; i++) {
         DFA::StateType final_state;
-        is >> final_state;
+        if (!(is >> final_state)) {
+            break;
+        }
         dfa.add_final_state(final_state);
     }
 
+    dfa.freeze();
     return is;
 }
 
+std::istream &operator>>(std::istream &is, DFA &dfa) {
+    return read_dfa(is, dfa);
+}
+
+TextReader &operator>>(TextReader &reader, DFA &dfa) {
+    return read_dfa(reader, dfa);
+}
+
 std::ostream &operator<<(std::ostream &os, const DFA &dfa) {
-    os << "DFA: s = " << dfa.initial_state << ", F = " << dfa.final_states
+    // States are written in ascending order, so that the output only
+    // depends on the DFA and not on how it was built
+    std::vector<DFA::StateType> final_states(dfa.final_states.begin(),
+                                             dfa.final_states.end());
+    std::ranges::sort(final_states);
+    os << "DFA: s = " << dfa.initial_state << ", F = " << final_states
        << '\n';
 
-    for (const auto &[src_state, symbol_map] : dfa.transition_map) {
-        for (const auto [symbol, dest_state] : symbol_map) {
-            os << src_state << " --" << symbol << "--> " << dest_state << '\n';
+    const auto &graph = dfa.get_frozen_graph();
+    std::vector<TransitionGraph::IndexType> states(graph.get_state_count());
+    std::iota(states.begin(), states.end(), 0);
+    std::ranges::sort(states, {}, [&](TransitionGraph::IndexType state) {
+        return graph.get_state_name(state);
+    });
+    for (auto state : states) {
+        for (auto edge : graph.get_edges(state)) {
+            os << graph.get_state_name(state) << " --"
+               << TransitionGraph::to_char(edge.symbol) << "--> "
+               << graph.get_state_name(edge.dest) << '\n';
         }
     }
 
@@ -4,20 +4,26 @@
 #include <ostream>
 
 #include "automaton.hpp"
+#include "compiled_dfa.hpp"
+#include "fingerprint.hpp"
 #include "nfa.hpp"
+#include "text_reader.hpp"
 
 class DFA : public Automaton {
 public:
     using SymbolType = char;
 
 protected:
-    using SymbolMap = std::unordered_map<SymbolType, StateType>;
-    using TransitionMap = std::unordered_map<StateType, SymbolMap>;
-    TransitionMap transition_map;
+    // Compiled form used for matching, built on first use.
+    std::shared_ptr<const CompiledDFA> compiled;
+
+    void invalidate_caches() override;
 
     [[nodiscard]] std::unordered_set<StateType> get_unreachable_states() const;
 
 public:
+    DFA() : Automaton(true) {}
+
     virtual void add_state(StateType state) override;
     virtual void add_transition(StateType src_state, StateType dest_state,
                                 SymbolType symbol);
@@ -25,13 +31,73 @@ public:
     std::optional<std::vector<StateType>>
     verify_word(const std::string &word) override;
 
+    /** Check if the word is accepted, without building a state chain. */
+    bool accepts(std::string_view word);
+    /** Check many independent words at once, see CompiledDFA. */
+    std::vector<bool> accepts_many(std::span<const std::string_view> words);
+
+    [[nodiscard]] CompiledDFA compile() const;
+    const CompiledDFA &get_compiled();
+
+    /** Matcher for chunked input, valid until the DFA is modified. */
+    CompiledDFA::Matcher create_matcher();
+
     [[nodiscard]] std::vector<SymbolType> get_alphabet() const;
 
+    /**
+     * The minimal DFA of the same language, in canonical form, see
+     * canonicalize. Equal languages give identical DFAs.
+     */
     [[nodiscard]] DFA minimize() const;
 
-    friend DFA NFA::to_dfa() const;
+    /**
+     * Rename the reachable states 0, 1, ... in BFS order from the initial
+     * state, following symbols in ascending order, and drop the others.
+     * DFAs which only differ in state names become identical.
+     */
+    [[nodiscard]] DFA canonicalize() const;
+
+    /**
+     * A fingerprint of the language, computed from the canonical minimal
+     * DFA. Equal languages have equal fingerprints.
+     */
+    [[nodiscard]] Fingerprint fingerprint() const;
+    /**
+     * Same as fingerprint, for a DFA returned by minimize, which is not
+     * minimized again.
+     */
+    [[nodiscard]] Fingerprint fingerprint_minimized() const;
+
+    /**
+     * Combine with another DFA via the product construction, see
+     * build_product_dfa. The results are not minimized.
+     */
+    [[nodiscard]] DFA intersect(const DFA &other) const;
+    [[nodiscard]] DFA unite(const DFA &other) const;
+    [[nodiscard]] DFA subtract(const DFA &other) const;
+    [[nodiscard]] DFA symmetric_difference(const DFA &other) const;
+
+    /** Accept the words over the alphabet which this DFA rejects. */
+    [[nodiscard]] DFA complement(std::span<const SymbolType> alphabet) const;
+    /** Same, over this DFA's own alphabet. */
+    [[nodiscard]] DFA complement() const;
+
+    /** Check if both DFAs accept the same language, see are_equivalent. */
+    [[nodiscard]] bool equivalent(const DFA &other) const;
+    /** A shortest word accepted by exactly one of the DFAs, if any. */
+    [[nodiscard]] std::optional<std::string>
+    find_difference(const DFA &other) const;
+
+    /** Check if other accepts every word this DFA accepts. */
+    [[nodiscard]] bool is_subset_of(const DFA &other) const;
+    /** A shortest word accepted by this DFA but not by other, if any. */
+    [[nodiscard]] std::optional<std::string>
+    find_inclusion_counterexample(const DFA &other) const;
+
+    friend CompiledDFA::CompiledDFA(const DFA &dfa);
     friend std::ostream &operator<<(std::ostream &os, const DFA &dfa);
 };
 
 std::istream &operator>>(std::istream &is, DFA &dfa);
+TextReader &operator>>(TextReader &reader, DFA &dfa);
 std::ostream &operator<<(std::ostream &os, const DFA &dfa);
@@ -0,0 +1,75 @@
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+#include "codegen.hpp"
+#include "dfa.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
+
+int main(int argc, char *argv[]) {
+    // Minimize the DFA read from the input, and write it as a C++ header
+    // with a matcher function, see write_goto_matcher, to the output or
+    // to stdout. Pass --name NAME to name the function, and --stats to
+    // write statistics as JSON to stderr at the end.
+    bool print_stats = false;
+    std::string_view name = "match_dfa";
+    const char *input_path = nullptr;
+    const char *output_path = nullptr;
+    bool is_usage_error = false;
+    for (int i = 1; i < argc && !is_usage_error; i++) {
+        if (std::string_view(argv[i]) == "--stats") {
+            print_stats = true;
+        } else if (std::string_view(argv[i]) == "--name") {
+            // The name goes into the header as is, so it must be valid C++
+            if (i + 1 == argc || !is_identifier(argv[i + 1])) {
+                is_usage_error = true;
+            } else {
+                name = argv[++i];
+            }
+        } else if (input_path == nullptr) {
+            input_path = argv[i];
+        } else {
+            output_path = argv[i];
+        }
+    }
+    if (is_usage_error || input_path == nullptr) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--stats] [--name identifier] <input> [output]\n";
+        return 1;
+    }
+
+    DFA dfa;
+    try {
+        MappedFile file(input_path);
+        TextReader reader(file.get_contents());
+        if (!(reader >> dfa)) {
+            std::cerr << "Could not parse " << input_path << '\n';
+            return 1;
+        }
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    auto minimized = dfa.minimize();
+    {
+        AUTOMATA_STATS_PHASE(output);
+        if (output_path != nullptr) {
+            std::ofstream ofs(output_path);
+            write_goto_matcher(ofs, minimized, name);
+            if (!ofs) {
+                std::cerr << "Could not write " << output_path << '\n';
+                return 1;
+            }
+        } else {
+            write_goto_matcher(std::cout, minimized, name);
+        }
+    }
+
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#include "dfa_cache.hpp"
+
+namespace {
+
+// Write through a file unique to this process, then rename it into place,
+// so that readers never see a partial file
+template <typename WriteFn>
+void write_atomically(const std::filesystem::path &path, WriteFn &&write) {
+    auto temporary_path = path;
+    temporary_path += ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream ofs(temporary_path, std::ios::binary);
+        write(ofs);
+        if (!ofs.flush()) {
+            throw std::runtime_error("Could not write " +
+                                     temporary_path.string());
+        }
+    }
+    std::filesystem::rename(temporary_path, path);
+}
+
+} // namespace
+
+DFACache::DFACache(std::filesystem::path directory)
+    : directory(std::move(directory)) {
+    std::filesystem::create_directories(this->directory / "dfa");
+    std::filesystem::create_directories(this->directory / "input");
+}
+
+std::filesystem::path
+DFACache::get_dfa_path(const Fingerprint &fingerprint) const {
+    return directory / "dfa" / (fingerprint.to_string() + ".dfab");
+}
+
+std::filesystem::path
+DFACache::get_input_path(const Fingerprint &input_key) const {
+    return directory / "input" / input_key.to_string();
+}
+
+std::optional<CompiledDFA>
+DFACache::find(const Fingerprint &fingerprint) const {
+    auto path = get_dfa_path(fingerprint);
+    if (!std::filesystem::exists(path)) {
+        return {};
+    }
+
+    try {
+        return CompiledDFA::load(path.string());
+    } catch (const std::runtime_error &) {
+        // A damaged entry is a miss, and is replaced by the next store
+        return {};
+    }
+}
+
+void DFACache::store(const Fingerprint &fingerprint,
+                     const CompiledDFA &dfa) const {
+    write_atomically(get_dfa_path(fingerprint),
+                     [&](std::ostream &os) { dfa.save(os); });
+}
+
+std::optional<DFACache::InputEntry>
+DFACache::find_input(const Fingerprint &input_key) const {
+    std::ifstream ifs(get_input_path(input_key));
+    std::string text(std::istreambuf_iterator<char>(ifs), {});
+
+    auto line_end = text.find('\n');
+    if (line_end == std::string::npos) {
+        return {};
+    }
+    auto fingerprint =
+        Fingerprint::parse(std::string_view(text).substr(0, line_end));
+    if (!fingerprint.has_value()) {
+        return {};
+    }
+    return InputEntry{fingerprint.value(), text.substr(line_end + 1)};
+}
+
+void DFACache::store_input(const Fingerprint &input_key,
+                           const InputEntry &entry) const {
+    write_atomically(get_input_path(input_key), [&](std::ostream &os) {
+        os << entry.fingerprint.to_string() << '\n' << entry.report;
+    });
+}
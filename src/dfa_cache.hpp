@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "compiled_dfa.hpp"
+#include "fingerprint.hpp"
+
+/**
+ * A content-addressed cache of compiled DFAs in a directory.
+ *
+ * Compiled canonical minimal DFAs are kept under their language
+ * fingerprint, in dfa/<fingerprint>.dfab, so equal languages are stored
+ * once. Inputs which were already built are mapped to the fingerprint of
+ * their result in input/<key>, where the key is a fingerprint of the input
+ * and of how it is built, so that they need not be parsed again. The
+ * fingerprint is on the first line, followed by the report.
+ *
+ * Files are written under a temporary name and renamed into place, so
+ * several processes can share a cache.
+ */
+class DFACache {
+public:
+    /**
+     * What was built from an input: the fingerprint of the resulting DFA,
+     * and the report written while building it, to be written again.
+     */
+    struct InputEntry {
+        Fingerprint fingerprint;
+        std::string report;
+    };
+
+private:
+    std::filesystem::path directory;
+
+    [[nodiscard]] std::filesystem::path
+    get_dfa_path(const Fingerprint &fingerprint) const;
+    [[nodiscard]] std::filesystem::path
+    get_input_path(const Fingerprint &input_key) const;
+
+public:
+    /** Creates the directory if needed. */
+    explicit DFACache(std::filesystem::path directory);
+
+    /** The DFA stored under the fingerprint, if there is a valid one. */
+    [[nodiscard]] std::optional<CompiledDFA>
+    find(const Fingerprint &fingerprint) const;
+    /** Store a compiled canonical minimal DFA of the language. */
+    void store(const Fingerprint &fingerprint, const CompiledDFA &dfa) const;
+
+    /** What was built from the input, if known. */
+    [[nodiscard]] std::optional<InputEntry>
+    find_input(const Fingerprint &input_key) const;
+    void store_input(const Fingerprint &input_key,
+                     const InputEntry &entry) const;
+};
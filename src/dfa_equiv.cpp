@@ -0,0 +1,109 @@
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "dfa.hpp"
+#include "mapped_file.hpp"
+#include "nfa.hpp"
+#include "stats.hpp"
+
+template <typename AutomatonT>
+static AutomatonT read_automaton(const char *path) {
+    MappedFile file(path);
+    TextReader reader(file.get_contents());
+
+    AutomatonT automaton;
+    if (!(reader >> automaton)) {
+        throw std::runtime_error(std::string("Could not parse ") + path);
+    }
+    return automaton;
+}
+
+template <typename AutomatonT>
+static std::optional<std::string>
+find_counterexample(const AutomatonT &first, const AutomatonT &second,
+                    bool is_inclusion) {
+    if constexpr (std::is_same_v<AutomatonT, DFA>) {
+        if (!is_inclusion) {
+            return first.find_difference(second);
+        }
+    } else if (!is_inclusion) {
+        // Equivalent NFAs include each other. A shortest word in the
+        // symmetric difference is the shorter of the two counterexamples.
+        auto word = first.find_inclusion_counterexample(second);
+        auto other_word = second.find_inclusion_counterexample(first);
+        if (!word.has_value() ||
+            (other_word.has_value() && other_word->size() < word->size())) {
+            return other_word;
+        }
+        return word;
+    }
+    return first.find_inclusion_counterexample(second);
+}
+
+int main(int argc, char *argv[]) {
+    // Check if two automata accept the same language, or with -i, if the
+    // first one's language is included in the second one's. Pass -n to read
+    // NFAs, which are compared without determinizing them, and --stats to
+    // write statistics as JSON to stderr at the end. Exits with 0 if the
+    // check holds, 1 with a shortest counterexample if it does not, and 2
+    // on bad usage or unreadable input, so that it can be used in scripts
+    // like diff.
+    bool is_inclusion = false;
+    bool is_nfa = false;
+    bool print_stats = false;
+    const char *first_path = nullptr;
+    const char *second_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "-i") {
+            is_inclusion = true;
+        } else if (std::string_view(argv[i]) == "-n") {
+            is_nfa = true;
+        } else if (std::string_view(argv[i]) == "--stats") {
+            print_stats = true;
+        } else if (first_path == nullptr) {
+            first_path = argv[i];
+        } else {
+            second_path = argv[i];
+        }
+    }
+    if (first_path == nullptr || second_path == nullptr) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-i] [-n] [--stats] <first> <second>\n";
+        return 2;
+    }
+
+    std::optional<std::string> counterexample;
+    try {
+        counterexample =
+            is_nfa ? find_counterexample(read_automaton<NFA>(first_path),
+                                         read_automaton<NFA>(second_path),
+                                         is_inclusion)
+                   : find_counterexample(read_automaton<DFA>(first_path),
+                                         read_automaton<DFA>(second_path),
+                                         is_inclusion);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 2;
+    }
+
+    {
+        AUTOMATA_STATS_PHASE(output);
+        if (counterexample.has_value()) {
+            std::cout << (is_inclusion ? "Not included" : "Not equivalent")
+                      << ", counterexample: \"" << counterexample.value()
+                      << "\"\n";
+        } else {
+            std::cout << (is_inclusion ? "Included" : "Equivalent") << '\n';
+        }
+    }
+
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
+
+    return counterexample.has_value() ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "dfa_scanner.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
+
+static void append_offset(std::string &output, std::size_t offset) {
+    char buffer[24];
+    auto end = std::to_chars(buffer, buffer + sizeof(buffer), offset).ptr;
+    output.append(buffer, end);
+}
+
+int main(int argc, char *argv[]) {
+    // Pass -s to print leftmost-longest match spans instead of match ends,
+    // and --stats to write statistics as JSON to stderr at the end.
+    bool print_spans = false;
+    bool print_stats = false;
+    const char *paths[2] = {nullptr, nullptr};
+    int path_count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "-s") {
+            print_spans = true;
+        } else if (std::string_view(argv[i]) == "--stats") {
+            print_stats = true;
+        } else if (path_count < 2) {
+            paths[path_count++] = argv[i];
+        }
+    }
+    if (path_count < 2) {
+        return 1;
+    }
+
+    // The automaton is read as an NFA, which also accepts DFA files
+    NFA nfa;
+    std::optional<MappedFile> text_file;
+    try {
+        MappedFile automaton_file(paths[0]);
+        TextReader reader(automaton_file.get_contents());
+        if (!(reader >> nfa)) {
+            std::cerr << "Could not parse " << paths[0] << '\n';
+            return 1;
+        }
+
+        text_file.emplace(paths[1]);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    DFAScanner scanner(nfa);
+    auto text = text_file->get_contents();
+
+    AUTOMATA_STATS_PHASE(matching);
+    std::string output;
+    auto flush_if_full = [&]() {
+        if (output.size() >= 1 << 16) {
+            AUTOMATA_STATS_PHASE(output);
+            std::cout << output;
+            output.clear();
+        }
+    };
+
+    if (print_spans) {
+        scanner.find_spans(text, [&](std::size_t begin, std::size_t end) {
+            append_offset(output, begin);
+            output += ' ';
+            append_offset(output, end);
+            output += '\n';
+            flush_if_full();
+        });
+    } else {
+        scanner.find_ends(text, [&](std::size_t end) {
+            append_offset(output, end);
+            output += '\n';
+            flush_if_full();
+        });
+    }
+    {
+        AUTOMATA_STATS_PHASE(output);
+        std::cout << output;
+    }
+
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+
+#include "dfa_scanner.hpp"
+#include "dfa.hpp"
+
+namespace {
+
+// Σ*L, where Σ is the alphabet of the NFA
+CompiledDFA build_unanchored(const NFA &nfa) {
+    NFA unanchored(nfa);
+    auto initial_state = unanchored.get_initial_state();
+    for (auto symbol : nfa.get_alphabet()) {
+        unanchored.add_transition(initial_state, initial_state, symbol);
+    }
+    unanchored.freeze();
+
+    return unanchored.to_dfa().minimize().compile();
+}
+
+} // namespace
+
+DFAScanner::DFAScanner(const NFA &nfa)
+    : unanchored(build_unanchored(nfa)),
+      anchored(nfa.to_dfa().minimize().compile()) {}
+
+std::size_t DFAScanner::find_first_end(std::string_view text,
+                                       std::size_t begin) const {
+    const auto initial_state = unanchored.get_initial_state();
+    if (unanchored.is_final(initial_state)) {
+        return begin;
+    }
+
+    auto state = initial_state;
+    for (auto i = begin; i < text.size(); i++) {
+        state = unanchored.next_state(state, text[i]);
+        if (state == CompiledDFA::dead_state) {
+            state = initial_state;
+        } else if (unanchored.is_final(state)) {
+            return i + 1;
+        }
+    }
+
+    return npos;
+}
+
+std::pair<std::size_t, std::size_t>
+DFAScanner::find_leftmost_longest(std::string_view text, std::size_t begin,
+                                  std::size_t first_end,
+                                  SpanSearch &search) const {
+    auto &[states, next_states, starts, next_starts] = search;
+    const auto initial_state = anchored.get_initial_state();
+
+    std::size_t match_begin = npos;
+    std::size_t match_end = npos;
+    for (auto i = begin;; i++) {
+        // Later starts cannot be leftmost once a match is known
+        if (i <= first_end && match_begin == npos &&
+            starts[initial_state] == npos) {
+            starts[initial_state] = i;
+            states.push_back(initial_state);
+        }
+
+        for (auto state : states) {
+            if (anchored.is_final(state) && starts[state] <= match_begin) {
+                match_begin = starts[state];
+                match_end = i;
+            }
+        }
+
+        if (i == text.size() ||
+            (states.empty() && (i >= first_end || match_begin != npos))) {
+            break;
+        }
+
+        for (auto state : states) {
+            auto start = starts[state];
+            starts[state] = npos;
+            if (match_begin != npos && start > match_begin) {
+                continue;
+            }
+
+            auto dest = anchored.next_state(state, text[i]);
+            if (dest == CompiledDFA::dead_state) {
+                continue;
+            }
+            if (next_starts[dest] == npos) {
+                next_starts[dest] = start;
+                next_states.push_back(dest);
+            } else {
+                next_starts[dest] = std::min(next_starts[dest], start);
+            }
+        }
+        states.swap(next_states);
+        starts.swap(next_starts);
+        next_states.clear();
+    }
+
+    for (auto state : states) {
+        starts[state] = npos;
+    }
+    states.clear();
+    return {match_begin, match_end};
+}
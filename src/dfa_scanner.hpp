@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "compiled_dfa.hpp"
+#include "nfa.hpp"
+
+/**
+ * Finds the words of a language inside a larger text.
+ *
+ * Match ends are found in one pass with an unanchored DFA for Σ*L, built by
+ * adding a self-loop over the alphabet to the NFA's initial state, then
+ * determinizing and minimizing it. Spans additionally use an anchored DFA
+ * for L to find where matches start and how far they extend.
+ */
+class DFAScanner {
+private:
+    CompiledDFA unanchored;
+    CompiledDFA anchored;
+
+    // First end offset of a match starting at or after begin, or npos.
+    [[nodiscard]] std::size_t find_first_end(std::string_view text,
+                                             std::size_t begin) const;
+
+    // Buffers reused across the searches of one find_spans call
+    struct SpanSearch {
+        // Active anchored states, and the earliest start which reached
+        // each of them, or npos
+        std::vector<CompiledDFA::IndexType> states;
+        std::vector<CompiledDFA::IndexType> next_states;
+        std::vector<std::size_t> starts;
+        std::vector<std::size_t> next_starts;
+    };
+
+    // Leftmost-longest match starting at or after begin, given the first
+    // end of a match from there. Matches from every start up to first_end
+    // run at once through the anchored DFA, and starts which reach the
+    // same state are merged into the earliest one, since they have the
+    // same future. So the search is linear in the text it reads.
+    [[nodiscard]] std::pair<std::size_t, std::size_t>
+    find_leftmost_longest(std::string_view text, std::size_t begin,
+                          std::size_t first_end, SpanSearch &search) const;
+
+public:
+    static constexpr std::size_t npos = std::string_view::npos;
+
+    explicit DFAScanner(const NFA &nfa);
+
+    /**
+     * Call on_match(end) for every offset in the text where some match
+     * ends, in increasing order.
+     */
+    template <typename Fn>
+    void find_ends(std::string_view text, Fn &&on_match) const {
+        const auto initial_state = unanchored.get_initial_state();
+        const bool is_initial_final = unanchored.is_final(initial_state);
+
+        auto state = initial_state;
+        if (is_initial_final) {
+            on_match(std::size_t(0));
+        }
+
+        for (std::size_t i = 0; i < text.size(); i++) {
+            state = unanchored.next_state(state, text[i]);
+            if (state == CompiledDFA::dead_state) {
+                // Only symbols outside the alphabet lead here, and no match
+                // can span them, so start over after the symbol.
+                state = initial_state;
+                if (is_initial_final) {
+                    on_match(i + 1);
+                }
+            } else if (unanchored.is_final(state)) {
+                on_match(i + 1);
+            }
+        }
+    }
+
+    /**
+     * Call on_match(begin, end) for the leftmost-longest, non-overlapping
+     * matches in the text, in increasing order. After an empty match, the
+     * search resumes one symbol later.
+     */
+    template <typename Fn>
+    void find_spans(std::string_view text, Fn &&on_match) const {
+        SpanSearch search;
+        search.starts.assign(anchored.get_state_count(), npos);
+        search.next_starts.assign(anchored.get_state_count(), npos);
+
+        std::size_t position = 0;
+        while (position <= text.size()) {
+            // Every match ending at the first end starts at or before it, so
+            // the leftmost match starts there at the latest.
+            auto first_end = find_first_end(text, position);
+            if (first_end == npos) {
+                return;
+            }
+
+            auto [begin, end] =
+                find_leftmost_longest(text, position, first_end, search);
+            on_match(begin, end);
+            position = end > begin ? end : begin + 1;
+        }
+    }
+};
@@ -0,0 +1,90 @@
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "compiled_dfa.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
+#include "text_reader.hpp"
+
+int main(int argc, char *argv[]) {
+    // Pass --stats to write statistics as JSON to stderr at the end
+    bool print_stats = false;
+    const char *paths[2] = {nullptr, nullptr};
+    int path_count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "--stats") {
+            print_stats = true;
+        } else if (path_count < 2) {
+            paths[path_count++] = argv[i];
+        }
+    }
+    if (path_count < 2) {
+        return 1;
+    }
+
+    // The compiled DFA is used straight from its mapping
+    std::optional<CompiledDFA> dfa;
+    std::optional<MappedFile> file;
+    try {
+        dfa.emplace(CompiledDFA::load(paths[0]));
+        file.emplace(paths[1]);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    TextReader reader(file->get_contents());
+
+    std::size_t word_count = 0;
+    if (!(reader >> word_count)) {
+        std::cerr << "Could not read the word count from " << paths[1]
+                  << '\n';
+        return 1;
+    }
+
+    AUTOMATA_STATS_PHASE(matching);
+    std::string output;
+    for (std::size_t i = 0; i < word_count; i++) {
+        std::string_view word;
+        if (!(reader >> word)) {
+            std::cout << output;
+            std::cerr << "Expected " << word_count << " words in " << paths[1]
+                      << ", found " << i << '\n';
+            return 1;
+        }
+
+        auto result = dfa->verify_word(word);
+        output += word;
+        output += ' ';
+        if (result.has_value()) {
+            output += "DA:";
+            for (auto state : result.value()) {
+                char buffer[16];
+                auto end =
+                    std::to_chars(buffer, buffer + sizeof(buffer), state).ptr;
+                output += " -> ";
+                output.append(buffer, end);
+            }
+        } else {
+            output += "NU";
+        }
+        output += '\n';
+
+        if (output.size() >= 1 << 16) {
+            AUTOMATA_STATS_PHASE(output);
+            std::cout << output;
+            output.clear();
+        }
+    }
+    {
+        AUTOMATA_STATS_PHASE(output);
+        std::cout << output;
+    }
+
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <bit>
+
+#include "fingerprint.hpp"
+
+namespace {
+
+constexpr std::uint64_t first_multiplier = 0x87c37b91114253d5;
+constexpr std::uint64_t second_multiplier = 0x4cf5ad432745937f;
+
+std::uint64_t mix_final(std::uint64_t word) {
+    word ^= word >> 33;
+    word *= 0xff51afd7ed558ccd;
+    word ^= word >> 33;
+    word *= 0xc4ceb9fe1a85ec53;
+    word ^= word >> 33;
+    return word;
+}
+
+} // namespace
+
+std::string Fingerprint::to_string() const {
+    constexpr char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; i++) {
+        text[15 - i] = digits[(high >> (4 * i)) & 0xf];
+        text[31 - i] = digits[(low >> (4 * i)) & 0xf];
+    }
+    return text;
+}
+
+std::optional<Fingerprint> Fingerprint::parse(std::string_view text) {
+    if (text.size() != 32) {
+        return {};
+    }
+
+    Fingerprint fingerprint;
+    for (std::size_t i = 0; i < text.size(); i++) {
+        std::uint64_t digit;
+        if (text[i] >= '0' && text[i] <= '9') {
+            digit = text[i] - '0';
+        } else if (text[i] >= 'a' && text[i] <= 'f') {
+            digit = text[i] - 'a' + 10;
+        } else {
+            return {};
+        }
+        auto &half = i < 16 ? fingerprint.high : fingerprint.low;
+        half = half << 4 | digit;
+    }
+    return fingerprint;
+}
+
+void FingerprintBuilder::add_block(std::uint64_t first_word,
+                                   std::uint64_t second_word) {
+    first_word *= first_multiplier;
+    first_word = std::rotl(first_word, 31);
+    first_word *= second_multiplier;
+    first_half ^= first_word;
+
+    first_half = std::rotl(first_half, 27);
+    first_half += second_half;
+    first_half = first_half * 5 + 0x52dce729;
+
+    second_word *= second_multiplier;
+    second_word = std::rotl(second_word, 33);
+    second_word *= first_multiplier;
+    second_half ^= second_word;
+
+    second_half = std::rotl(second_half, 31);
+    second_half += first_half;
+    second_half = second_half * 5 + 0x38495ab5;
+}
+
+void FingerprintBuilder::add(std::uint64_t word) {
+    word_count++;
+    if (has_pending_word) {
+        add_block(pending_word, word);
+        has_pending_word = false;
+    } else {
+        pending_word = word;
+        has_pending_word = true;
+    }
+}
+
+void FingerprintBuilder::add(std::string_view bytes) {
+    add(bytes.size());
+    // Little-endian words, so that the result does not depend on the
+    // platform
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < bytes.size(); i++) {
+        word |= std::uint64_t(static_cast<unsigned char>(bytes[i]))
+                << (8 * (i % 8));
+        if (i % 8 == 7) {
+            add(word);
+            word = 0;
+        }
+    }
+    if (bytes.size() % 8 != 0) {
+        add(word);
+    }
+}
+
+Fingerprint FingerprintBuilder::finish() const {
+    auto first = first_half;
+    auto second = second_half;
+    if (has_pending_word) {
+        auto word = pending_word * first_multiplier;
+        word = std::rotl(word, 31);
+        word *= second_multiplier;
+        first ^= word;
+    }
+
+    first ^= word_count;
+    second ^= word_count;
+    first += second;
+    second += first;
+    first = mix_final(first);
+    second = mix_final(second);
+    first += second;
+    second += first;
+    return {first, second};
+}
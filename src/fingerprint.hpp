@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/** A 128-bit hash, stable across runs and platforms. */
+struct Fingerprint {
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+
+    /** 32 lowercase hex digits, high half first. */
+    [[nodiscard]] std::string to_string() const;
+    /** Parse the output of to_string(), or nothing if it is malformed. */
+    static std::optional<Fingerprint> parse(std::string_view text);
+
+    bool operator==(const Fingerprint &other) const = default;
+};
+
+/**
+ * Builds a Fingerprint from a stream of 64-bit words or bytes, mixing them
+ * as in MurmurHash3's x64 128-bit variant. The result only depends on the
+ * values added, not on byte order. Not meant to resist deliberate
+ * collisions.
+ */
+class FingerprintBuilder {
+private:
+    std::uint64_t first_half;
+    std::uint64_t second_half;
+    // A word waiting for the second word of its block
+    std::uint64_t pending_word = 0;
+    bool has_pending_word = false;
+    std::uint64_t word_count = 0;
+
+    void add_block(std::uint64_t first_word, std::uint64_t second_word);
+
+public:
+    explicit FingerprintBuilder(std::uint64_t seed = 0)
+        : first_half(seed), second_half(seed) {}
+
+    void add(std::uint64_t word);
+    /** Add the bytes, preceded by their count. */
+    void add(std::string_view bytes);
+
+    [[nodiscard]] Fingerprint finish() const;
+};
@@ -0,0 +1,103 @@
+#include "generators.hpp"
+
+std::ostream &operator<<(std::ostream &os, const AutomatonSpec &spec) {
+    os << spec.state_count << '\n';
+    for (std::size_t state = 0; state < spec.state_count; state++) {
+        os << state << (state + 1 < spec.state_count ? ' ' : '\n');
+    }
+
+    os << spec.transitions.size() << '\n';
+    for (const auto &transition : spec.transitions) {
+        os << transition.src_state << ' ' << transition.dest_state << ' '
+           << transition.symbol.value_or('_') << '\n';
+    }
+
+    os << spec.initial_state << '\n';
+    os << spec.final_states.size() << '\n';
+    for (auto state : spec.final_states) {
+        os << state << '\n';
+    }
+
+    return os;
+}
+
+AutomatonSpec generate_random_dfa(std::size_t state_count,
+                                  std::string_view alphabet,
+                                  std::mt19937_64 &rng) {
+    using StateType = AutomatonSpec::StateType;
+
+    AutomatonSpec spec;
+    spec.state_count = state_count;
+    std::uniform_int_distribution<StateType> state_distribution(
+        0, static_cast<StateType>(state_count) - 1);
+    for (std::size_t state = 0; state < state_count; state++) {
+        for (auto symbol : alphabet) {
+            spec.transitions.push_back({static_cast<StateType>(state),
+                                        state_distribution(rng), symbol});
+        }
+        if (rng() % 3 == 0) {
+            spec.final_states.push_back(static_cast<StateType>(state));
+        }
+    }
+
+    return spec;
+}
+
+AutomatonSpec generate_blowup_nfa(std::size_t n) {
+    using StateType = AutomatonSpec::StateType;
+
+    // State 0 loops, state i has read the a and i - 1 more symbols
+    AutomatonSpec spec;
+    spec.state_count = n + 2;
+    spec.transitions.push_back({0, 0, 'a'});
+    spec.transitions.push_back({0, 0, 'b'});
+    spec.transitions.push_back({0, 1, 'a'});
+    for (StateType state = 1; state <= static_cast<StateType>(n); state++) {
+        spec.transitions.push_back({state, state + 1, 'a'});
+        spec.transitions.push_back({state, state + 1, 'b'});
+    }
+    spec.final_states.push_back(static_cast<StateType>(n + 1));
+
+    return spec;
+}
+
+AutomatonSpec generate_lambda_chain(std::size_t length,
+                                    std::string_view alphabet) {
+    using StateType = AutomatonSpec::StateType;
+
+    AutomatonSpec spec;
+    spec.state_count = length;
+    for (std::size_t state = 0; state < length; state++) {
+        if (state + 1 < length) {
+            spec.transitions.push_back({static_cast<StateType>(state),
+                                        static_cast<StateType>(state + 1),
+                                        std::nullopt});
+        }
+        spec.transitions.push_back({static_cast<StateType>(state), 0,
+                                    alphabet[state % alphabet.size()]});
+    }
+    spec.final_states.push_back(static_cast<StateType>(length) - 1);
+
+    return spec;
+}
+
+std::vector<std::string> generate_words(std::size_t count,
+                                        std::size_t min_length,
+                                        std::size_t max_length,
+                                        std::string_view alphabet,
+                                        std::mt19937_64 &rng) {
+    std::uniform_int_distribution<std::size_t> length_distribution(min_length,
+                                                                   max_length);
+    std::uniform_int_distribution<std::size_t> symbol_distribution(
+        0, alphabet.size() - 1);
+
+    std::vector<std::string> words(count);
+    for (auto &word : words) {
+        word.resize(length_distribution(rng));
+        for (auto &symbol : word) {
+            symbol = alphabet[symbol_distribution(rng)];
+        }
+    }
+
+    return words;
+}
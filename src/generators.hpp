@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "automaton.hpp"
+
+/**
+ * A generated automaton over the states 0..state_count-1, which can be built
+ * as any automaton class, or written in the format the readers expect.
+ */
+struct AutomatonSpec {
+    using StateType = Automaton::StateType;
+
+    struct Transition {
+        StateType src_state;
+        StateType dest_state;
+        // No symbol for λ-transitions
+        std::optional<char> symbol;
+    };
+
+    std::size_t state_count = 0;
+    std::vector<Transition> transitions;
+    StateType initial_state = 0;
+    std::vector<StateType> final_states;
+
+    /** Build a frozen DFA, NFA or LNFA. An LNFA gets its lambda closures. */
+    template <typename AutomatonT> [[nodiscard]] AutomatonT build() const {
+        AutomatonT automaton;
+        for (std::size_t state = 0; state < state_count; state++) {
+            automaton.add_state(static_cast<StateType>(state));
+        }
+        for (const auto &transition : transitions) {
+            if constexpr (std::is_same_v<typename AutomatonT::SymbolType,
+                                         char>) {
+                automaton.add_transition(transition.src_state,
+                                         transition.dest_state,
+                                         *transition.symbol);
+            } else {
+                automaton.add_transition(transition.src_state,
+                                         transition.dest_state,
+                                         transition.symbol);
+            }
+        }
+        automaton.set_initial_state(initial_state);
+        for (auto state : final_states) {
+            automaton.add_final_state(state);
+        }
+
+        if constexpr (requires { automaton.build_lambda_closures(); }) {
+            automaton.build_lambda_closures();
+        } else {
+            automaton.freeze();
+        }
+        return automaton;
+    }
+};
+
+/** Write in the input format, with λ-transitions as '_'. */
+std::ostream &operator<<(std::ostream &os, const AutomatonSpec &spec);
+
+/**
+ * A complete DFA with random transitions, where about a third of the states
+ * are final.
+ */
+AutomatonSpec generate_random_dfa(std::size_t state_count,
+                                  std::string_view alphabet,
+                                  std::mt19937_64 &rng);
+
+/**
+ * The NFA for (a|b)*a(a|b){n}, whose DFA has 2^(n+1) states, as it has to
+ * remember the last n + 1 symbols.
+ */
+AutomatonSpec generate_blowup_nfa(std::size_t n);
+
+/**
+ * An LNFA whose states form a chain of λ-transitions, so that the closure
+ * of the initial state holds every state. Every state also goes back to the
+ * initial state via one symbol of the alphabet, and the last state is final.
+ */
+AutomatonSpec generate_lambda_chain(std::size_t length,
+                                    std::string_view alphabet);
+
+/** Random words over the alphabet, with lengths in [min_length, max_length]. */
+std::vector<std::string> generate_words(std::size_t count,
+                                        std::size_t min_length,
+                                        std::size_t max_length,
+                                        std::string_view alphabet,
+                                        std::mt19937_64 &rng);
@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "language_checks.hpp"
+
+namespace {
+
+using IndexType = CompiledDFA::IndexType;
+
+// One symbol for every pair of byte classes in the two DFAs. All symbols
+// of a pair lead to the same pair of states everywhere.
+std::vector<char> get_common_alphabet(const CompiledDFA &first,
+                                      const CompiledDFA &second) {
+    std::vector<char> alphabet;
+    std::vector<bool> has_pair(first.get_class_count() *
+                               second.get_class_count());
+    for (int byte = 0; byte < 256; byte++) {
+        auto symbol = static_cast<char>(byte);
+        auto pair = first.get_byte_class(symbol) * second.get_class_count() +
+                    second.get_byte_class(symbol);
+        if (!has_pair[pair]) {
+            has_pair[pair] = true;
+            alphabet.push_back(symbol);
+        }
+    }
+    return alphabet;
+}
+
+class UnionFind {
+private:
+    std::vector<IndexType> parents;
+
+public:
+    explicit UnionFind(std::size_t size) : parents(size) {
+        std::iota(parents.begin(), parents.end(), 0);
+    }
+
+    IndexType find(IndexType element) {
+        while (parents[element] != element) {
+            // Path halving
+            parents[element] = parents[parents[element]];
+            element = parents[element];
+        }
+        return element;
+    }
+
+    /** Returns false if both were already in the same set. */
+    bool unite(IndexType first, IndexType second) {
+        first = find(first);
+        second = find(second);
+        if (first == second) {
+            return false;
+        }
+        parents[first] = second;
+        return true;
+    }
+};
+
+// A shortest word leading from the initial pair to a pair for which
+// is_counterexample(first_state, second_state) holds
+template <typename PredicateFn>
+std::optional<std::string> find_shortest_word(const CompiledDFA &first,
+                                              const CompiledDFA &second,
+                                              PredicateFn &&is_counterexample) {
+    const auto alphabet = get_common_alphabet(first, second);
+
+    struct Visit {
+        IndexType first_state;
+        IndexType second_state;
+        // Index of the visit this one was reached from, and the symbol
+        std::size_t parent;
+        char symbol;
+    };
+    std::vector<Visit> visits{{first.get_initial_state(),
+                               second.get_initial_state(), 0, '\0'}};
+    std::unordered_map<std::uint64_t, std::size_t> visited;
+    auto get_key = [](IndexType first_state, IndexType second_state) {
+        return std::uint64_t(first_state) << 32 | second_state;
+    };
+    visited.emplace(get_key(first.get_initial_state(),
+                            second.get_initial_state()),
+                    0);
+
+    for (std::size_t i = 0; i < visits.size(); i++) {
+        const auto first_state = visits[i].first_state;
+        const auto second_state = visits[i].second_state;
+        if (is_counterexample(first_state, second_state)) {
+            std::string word;
+            for (auto visit = i; visit != 0; visit = visits[visit].parent) {
+                word += visits[visit].symbol;
+            }
+            std::ranges::reverse(word);
+            return word;
+        }
+
+        if (first_state == CompiledDFA::dead_state &&
+            second_state == CompiledDFA::dead_state) {
+            // Both stay dead, and so agree on everything
+            continue;
+        }
+
+        for (auto next_symbol : alphabet) {
+            auto first_dest = first.next_state(first_state, next_symbol);
+            auto second_dest = second.next_state(second_state, next_symbol);
+            auto was_inserted =
+                visited.try_emplace(get_key(first_dest, second_dest), i)
+                    .second;
+            if (was_inserted) {
+                visits.push_back({first_dest, second_dest, i, next_symbol});
+            }
+        }
+    }
+
+    return {};
+}
+
+bool is_subset(const StateSet &subset, const StateSet &superset) {
+    const auto &subset_words = subset.get_words();
+    const auto &superset_words = superset.get_words();
+    for (std::size_t i = 0; i < subset_words.size(); i++) {
+        if (subset_words[i] & ~superset_words[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool are_equivalent(const CompiledDFA &first, const CompiledDFA &second) {
+    const auto alphabet = get_common_alphabet(first, second);
+
+    // States of the second DFA follow those of the first
+    const auto offset = static_cast<IndexType>(first.get_state_count());
+    UnionFind classes(first.get_state_count() + second.get_state_count());
+
+    std::vector<std::pair<IndexType, IndexType>> pending{
+        {first.get_initial_state(), second.get_initial_state()}};
+    classes.unite(first.get_initial_state(),
+                  second.get_initial_state() + offset);
+
+    while (!pending.empty()) {
+        auto [first_state, second_state] = pending.back();
+        pending.pop_back();
+
+        if (first.is_final(first_state) != second.is_final(second_state)) {
+            return false;
+        }
+
+        for (auto symbol : alphabet) {
+            auto first_dest = first.next_state(first_state, symbol);
+            auto second_dest = second.next_state(second_state, symbol);
+            if (classes.unite(first_dest, second_dest + offset)) {
+                pending.emplace_back(first_dest, second_dest);
+            }
+        }
+    }
+
+    return true;
+}
+
+std::optional<std::string> find_difference(const CompiledDFA &first,
+                                           const CompiledDFA &second) {
+    if (are_equivalent(first, second)) {
+        return {};
+    }
+
+    return find_shortest_word(
+        first, second, [&](IndexType first_state, IndexType second_state) {
+            return first.is_final(first_state) !=
+                   second.is_final(second_state);
+        });
+}
+
+std::optional<std::string>
+find_inclusion_counterexample(const CompiledDFA &first,
+                              const CompiledDFA &second) {
+    return find_shortest_word(
+        first, second, [&](IndexType first_state, IndexType second_state) {
+            return first.is_final(first_state) &&
+                   !second.is_final(second_state);
+        });
+}
+
+std::optional<std::string>
+find_inclusion_counterexample(const BitsetNFA &first, const BitsetNFA &second) {
+    using NFAIndexType = BitsetNFA::IndexType;
+
+    struct Visit {
+        NFAIndexType first_state;
+        StateSet second_states;
+        std::size_t parent;
+        char symbol;
+    };
+    std::vector<Visit> visits;
+    // Minimal sets of the second automaton seen with every state of the
+    // first one
+    std::vector<std::vector<StateSet>> antichains(first.get_state_count());
+
+    auto is_subsumed = [&](NFAIndexType first_state,
+                           const StateSet &second_states) {
+        return std::ranges::any_of(
+            antichains[first_state], [&](const StateSet &seen_states) {
+                return is_subset(seen_states, second_states);
+            });
+    };
+
+    auto add_visit = [&](NFAIndexType first_state, StateSet second_states,
+                         std::size_t parent, char symbol) {
+        if (is_subsumed(first_state, second_states)) {
+            return;
+        }
+        // Larger sets are subsumed by the new one from now on
+        auto &antichain = antichains[first_state];
+        std::erase_if(antichain, [&](const StateSet &seen_states) {
+            return is_subset(second_states, seen_states);
+        });
+        antichain.push_back(second_states);
+        visits.push_back({first_state, std::move(second_states), parent,
+                          symbol});
+    };
+
+    first.get_initial_states().for_each([&](std::size_t state) {
+        add_visit(state, second.get_initial_states(), 0, '\0');
+    });
+    // Initial visits have no parent
+    const auto initial_count = visits.size();
+
+    StateSet next_states(second.get_state_count());
+    for (std::size_t i = 0; i < visits.size(); i++) {
+        const auto first_state = visits[i].first_state;
+        if (first.is_final(first_state) &&
+            !second.contains_final_state(visits[i].second_states)) {
+            std::string word;
+            for (auto visit = i; visit >= initial_count;
+                 visit = visits[visit].parent) {
+                word += visits[visit].symbol;
+            }
+            std::ranges::reverse(word);
+            return word;
+        }
+
+        for (std::size_t symbol_index = 0;
+             symbol_index < first.get_symbol_count(); symbol_index++) {
+            if (!first.has_successors(first_state, symbol_index)) {
+                continue;
+            }
+            const auto symbol = first.get_symbol(symbol_index);
+
+            next_states.clear();
+            auto second_index = second.get_symbol_index(symbol);
+            if (second_index >= 0) {
+                visits[i].second_states.for_each([&](std::size_t state) {
+                    second.add_successors(state, second_index, next_states);
+                });
+            }
+
+            first.for_each_successor(
+                first_state, symbol_index, [&](std::size_t dest) {
+                    add_visit(dest, next_states, i, symbol);
+                });
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "bitset_nfa.hpp"
+#include "compiled_dfa.hpp"
+
+/**
+ * Check if two DFAs accept the same language, with Hopcroft and Karp's
+ * union-find algorithm. States which must be equivalent are merged as they
+ * are found, so it takes near-linear time in the total number of states,
+ * and needs no minimization.
+ */
+bool are_equivalent(const CompiledDFA &first, const CompiledDFA &second);
+
+/**
+ * A shortest word accepted by exactly one of the DFAs, or nothing if they
+ * are equivalent. Found by BFS over pairs of states.
+ */
+std::optional<std::string> find_difference(const CompiledDFA &first,
+                                           const CompiledDFA &second);
+
+/**
+ * A shortest word accepted by the first DFA but not by the second, or
+ * nothing if the first language is included in the second.
+ */
+std::optional<std::string>
+find_inclusion_counterexample(const CompiledDFA &first,
+                              const CompiledDFA &second);
+
+/**
+ * Same as for DFAs, without determinizing either automaton. A BFS runs over
+ * pairs of a state of the first automaton and a set of states of the
+ * second. A pair is skipped when a pair with the same state and a subset of
+ * its set was seen before, since any counterexample from it works from the
+ * smaller set too. The first counterexample found is a shortest one.
+ */
+std::optional<std::string>
+find_inclusion_counterexample(const BitsetNFA &first, const BitsetNFA &second);
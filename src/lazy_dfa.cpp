@@ -0,0 +1,79 @@
+#include "lazy_dfa.hpp"
+
+#include <algorithm>
+
+LazyDFA::LazyDFA(const BitsetNFA &nfa, std::size_t memory_budget)
+    : nfa(&nfa), memory_budget(memory_budget), subsets(nfa.get_word_count()),
+      reached_states(nfa.get_state_count()) {
+    clear_cache();
+}
+
+std::size_t LazyDFA::get_state_size() const {
+    // Subset bits, its hash and table slots, its transitions and final flag
+    return nfa->get_word_count() * sizeof(StateSet::WordType) +
+           sizeof(std::uint64_t) + 2 * sizeof(SubsetTable::IndexType) +
+           nfa->get_symbol_count() * sizeof(IndexType) + 1;
+}
+
+LazyDFA::IndexType
+LazyDFA::add_state(std::span<const StateSet::WordType> subset) {
+    auto [state, was_inserted] = subsets.insert(subset);
+    if (was_inserted) {
+        transitions.resize(transitions.size() + nfa->get_symbol_count(),
+                           unknown_state);
+        final_flags.push_back(nfa->contains_final_state(subset));
+    }
+    return state;
+}
+
+void LazyDFA::clear_cache() {
+    subsets = SubsetTable(nfa->get_word_count());
+    transitions.clear();
+    final_flags.clear();
+
+    add_state(StateSet(nfa->get_state_count()).get_words());
+    // The dead state goes nowhere else
+    std::fill(transitions.begin(), transitions.end(), dead_state);
+
+    initial_state = add_state(nfa->get_initial_states().get_words());
+}
+
+LazyDFA::IndexType LazyDFA::compute_next_state(IndexType state,
+                                               std::size_t symbol_index) {
+    // Union of the successors of every state in the subset
+    reached_states.clear();
+    StateSet::for_each(subsets.get(state), [&](std::size_t nfa_state) {
+        nfa->add_successors(nfa_state, symbol_index, reached_states);
+    });
+
+    auto existing_state = subsets.find(reached_states.get_words());
+    if (existing_state != SubsetTable::no_subset) {
+        transitions[state * nfa->get_symbol_count() + symbol_index] =
+            existing_state;
+        return existing_state;
+    }
+
+    if ((subsets.size() + 1) * get_state_size() > memory_budget) {
+        // Over budget: start over, keeping only the state being entered.
+        // The source state is gone, so its transition is not cached.
+        clear_cache();
+        clear_count++;
+        return add_state(reached_states.get_words());
+    }
+
+    auto dest_state = add_state(reached_states.get_words());
+    transitions[state * nfa->get_symbol_count() + symbol_index] = dest_state;
+    return dest_state;
+}
+
+bool LazyDFA::accepts(std::string_view word) {
+    auto state = initial_state;
+    for (auto symbol : word) {
+        state = next_state(state, symbol);
+        if (state == dead_state) {
+            return false;
+        }
+    }
+
+    return is_final(state);
+}
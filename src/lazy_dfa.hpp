@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "bitset_nfa.hpp"
+#include "subset_table.hpp"
+
+/**
+ * A DFA built on demand from a BitsetNFA while matching.
+ *
+ * DFA states are subsets of NFA states, created only when the input reaches
+ * them, and their transitions are filled in as they are first taken. All of
+ * it is cached within a memory budget. When the budget is exceeded, the
+ * cache is cleared and matching continues from the current subset, so
+ * memory stays bounded even when the full DFA would blow up.
+ *
+ * Matching updates the cache, so a LazyDFA must not be shared between
+ * threads. It borrows the BitsetNFA.
+ */
+class LazyDFA {
+public:
+    using IndexType = std::uint32_t;
+
+    // The empty subset, which every missing transition leads to
+    static constexpr IndexType dead_state = 0;
+
+private:
+    static constexpr IndexType unknown_state = UINT32_MAX;
+
+    const BitsetNFA *nfa;
+    std::size_t memory_budget;
+    std::size_t clear_count = 0;
+
+    SubsetTable subsets;
+    // Destination of every (state, symbol), or unknown_state
+    std::vector<IndexType> transitions;
+    std::vector<bool> final_flags;
+    IndexType initial_state;
+
+    StateSet reached_states;
+
+    // Approximate bytes used by the cache per DFA state
+    [[nodiscard]] std::size_t get_state_size() const;
+
+    IndexType add_state(std::span<const StateSet::WordType> subset);
+    void clear_cache();
+
+    // Compute a transition which is not cached yet
+    IndexType compute_next_state(IndexType state, std::size_t symbol_index);
+
+public:
+    explicit LazyDFA(const BitsetNFA &nfa,
+                     std::size_t memory_budget = std::size_t(64) << 20);
+
+    [[nodiscard]] IndexType get_initial_state() const { return initial_state; }
+    [[nodiscard]] bool is_final(IndexType state) const {
+        return final_flags[state];
+    }
+
+    IndexType next_state(IndexType state, char symbol) {
+        auto symbol_index = nfa->get_symbol_index(symbol);
+        if (symbol_index < 0) {
+            return dead_state;
+        }
+
+        auto dest_state =
+            transitions[state * nfa->get_symbol_count() + symbol_index];
+        if (dest_state == unknown_state) {
+            dest_state = compute_next_state(state, symbol_index);
+        }
+        return dest_state;
+    }
+
+    bool accepts(std::string_view word);
+
+    /** Number of DFA states currently cached. */
+    [[nodiscard]] std::size_t get_state_count() const { return subsets.size(); }
+    /** Number of times the cache was cleared for exceeding the budget. */
+    [[nodiscard]] std::size_t get_clear_count() const { return clear_count; }
+};
@@ -1,152 +1,507 @@
 #include "lnfa.hpp"
-#include <queue>
+#include "dfa.hpp"
+#include "nfa.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+#include "subset_construction.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+void LNFA::invalidate_caches() { are_lambda_closures_built = false; }
 
 void LNFA::add_state(StateType state) {
-    transition_map[state] = SymbolMap();
-    lambda_closures[state] = {state};
+    transition_graph.add_state(state);
+    invalidate_caches();
 }
 
 void LNFA::add_transition(StateType src_state, StateType dest_state,
                           SymbolType symbol) {
-    transition_map[src_state][symbol].push_back(dest_state);
+    transition_graph.add_transition(
+        src_state, dest_state,
+        symbol.has_value() ? TransitionGraph::to_symbol(*symbol)
+                           : TransitionGraph::lambda_symbol);
+
+    if (!lambda_closure_indices.empty()) {
+        // Closures were computed before, so only update them
+        if (symbol.has_value()) {
+            pending_sources.push_back(transition_graph.find_state(src_state));
+        } else {
+            pending_lambda_edges.emplace_back(
+                transition_graph.find_state(src_state),
+                transition_graph.find_state(dest_state));
+        }
+    }
+
+    invalidate_caches();
 }
 
 void LNFA::build_lambda_closures() {
-    // Build lambda closure for every state
-    std::queue<StateType> state_queue;
-    for (auto src_pair : transition_map) {
-        auto src_state = src_pair.first;
-        auto &src_closure = lambda_closures[src_state];
-
-        // BFS
-        state_queue.push(src_state);
-        while (!state_queue.empty()) {
-            auto state = state_queue.front();
-            state_queue.pop();
-
-            // Insert states that we can reach via lambda
-            for (auto reachable_state : transition_map[state][{}]) {
-                auto result = src_closure.insert(reachable_state);
-                if (result.second) {
-                    // reachable_state was new to the closure, so queue it
-                    state_queue.push(reachable_state);
+    if (are_lambda_closures_built) {
+        return;
+    }
+    AUTOMATA_STATS_PHASE(closure_build);
+
+    freeze();
+    if (lambda_closure_indices.empty()) {
+        compute_lambda_closures();
+        are_lambda_closures_built = true;
+        simulation = std::make_shared<BitsetNFA>(*this);
+        return;
+    }
+
+    // Successors change for states with new edges, and for states with an
+    // edge into a changed closure
+    const auto &graph = transition_graph;
+    auto changed_closures = update_lambda_closures();
+    StateSet changed_states(graph.get_state_count());
+    for (auto state : pending_sources) {
+        changed_states.insert(state);
+    }
+    pending_sources.clear();
+    if (!changed_closures.empty()) {
+        for (IndexType state = 0; state < graph.get_state_count(); state++) {
+            for (auto edge : graph.get_edges(state)) {
+                if (edge.symbol != TransitionGraph::lambda_symbol &&
+                    changed_closures.contains(edge.dest)) {
+                    changed_states.insert(state);
+                    break;
                 }
             }
         }
     }
+
+    are_lambda_closures_built = true;
+    if (simulation.use_count() > 1) {
+        // Shared with a copy of this LNFA, which must keep its own
+        simulation = std::make_shared<BitsetNFA>(*simulation);
+    }
+    simulation->update(*this, changed_states);
+}
+
+void LNFA::compute_lambda_closures() {
+    const auto &graph = transition_graph;
+    const auto state_count = graph.get_state_count();
+
+    lambda_closure_indices.assign(state_count, trivial_closure);
+    lambda_closures.clear();
+    pending_lambda_edges.clear();
+    pending_sources.clear();
+
+    // Tarjan's algorithm over the λ-edges. Components are completed in
+    // reverse topological order, so the closures of the components a
+    // component reaches are always known before its own.
+    constexpr IndexType unvisited = UINT32_MAX;
+    std::vector<IndexType> visit_order(state_count, unvisited);
+    std::vector<IndexType> low_link(state_count);
+    std::vector<bool> is_on_stack(state_count, false);
+    std::vector<IndexType> component_stack;
+    // DFS frames of (state, number of λ-edges followed)
+    std::vector<std::pair<IndexType, std::size_t>> frames;
+    IndexType next_order = 0;
+
+    auto visit = [&](IndexType state) {
+        visit_order[state] = low_link[state] = next_order++;
+        component_stack.push_back(state);
+        is_on_stack[state] = true;
+        frames.emplace_back(state, 0);
+    };
+
+    auto complete_component = [&](IndexType root) {
+        // The component is on top of the stack, down to its root
+        auto component_begin = component_stack.size() - 1;
+        while (component_stack[component_begin] != root) {
+            component_begin--;
+        }
+        std::span<const IndexType> component(
+            component_stack.data() + component_begin,
+            component_stack.size() - component_begin);
+
+        bool is_trivial =
+            component.size() == 1 &&
+            std::ranges::all_of(
+                graph.get_edges(root, TransitionGraph::lambda_symbol),
+                [&](auto edge) { return edge.dest == root; });
+        if (is_trivial) {
+            is_on_stack[root] = false;
+            component_stack.pop_back();
+            return;
+        }
+
+        StateSet closure(state_count);
+        for (auto state : component) {
+            closure.insert(state);
+            is_on_stack[state] = false;
+        }
+        for (auto state : component) {
+            for (auto edge :
+                 graph.get_edges(state, TransitionGraph::lambda_symbol)) {
+                add_lambda_closure(edge.dest, closure.get_words().data());
+            }
+        }
+
+        IndexType closure_index = lambda_closures.size();
+        lambda_closures.push_back(std::move(closure));
+        for (auto state : component) {
+            lambda_closure_indices[state] = closure_index;
+        }
+        component_stack.resize(component_begin);
+    };
+
+    for (IndexType root = 0; root < state_count; root++) {
+        if (visit_order[root] != unvisited) {
+            continue;
+        }
+
+        visit(root);
+        while (!frames.empty()) {
+            auto [state, followed_count] = frames.back();
+            auto edges = graph.get_edges(state, TransitionGraph::lambda_symbol);
+            if (followed_count < edges.size()) {
+                frames.back().second++;
+                auto dest_state = edges[followed_count].dest;
+                if (visit_order[dest_state] == unvisited) {
+                    visit(dest_state);
+                } else if (is_on_stack[dest_state]) {
+                    low_link[state] =
+                        std::min(low_link[state], visit_order[dest_state]);
+                }
+                continue;
+            }
+
+            // Every λ-edge was followed
+            frames.pop_back();
+            if (!frames.empty()) {
+                auto parent = frames.back().first;
+                low_link[parent] = std::min(low_link[parent], low_link[state]);
+            }
+            if (low_link[state] == visit_order[state]) {
+                complete_component(state);
+            }
+        }
+    }
+}
+
+StateSet LNFA::update_lambda_closures() {
+    const auto state_count = transition_graph.get_state_count();
+
+    // New states only reach themselves until their λ-edges are added
+    lambda_closure_indices.resize(state_count, trivial_closure);
+    for (auto &closure : lambda_closures) {
+        closure.resize(state_count);
+    }
+
+    std::vector<bool> is_closure_changed(lambda_closures.size(), false);
+    StateSet dest_closure(state_count);
+    for (auto [src_state, dest_state] : pending_lambda_edges) {
+        // Every state which reaches src_state now also reaches the closure
+        // of dest_state, which itself stays the same. Closures are closed
+        // under λ-edges, so one which holds dest_state holds its closure.
+        dest_closure.clear();
+        add_lambda_closure(dest_state, dest_closure.get_words().data());
+        for (std::size_t i = 0; i < lambda_closures.size(); i++) {
+            auto &closure = lambda_closures[i];
+            if (closure.contains(src_state) && !closure.contains(dest_state)) {
+                closure |= dest_closure;
+                is_closure_changed[i] = true;
+            }
+        }
+
+        if (lambda_closure_indices[src_state] == trivial_closure &&
+            src_state != dest_state) {
+            dest_closure.insert(src_state);
+            lambda_closure_indices[src_state] = lambda_closures.size();
+            lambda_closures.push_back(dest_closure);
+            is_closure_changed.push_back(true);
+        }
+    }
+    pending_lambda_edges.clear();
+
+    StateSet changed_states(state_count);
+    for (std::size_t state = 0; state < state_count; state++) {
+        auto closure_index = lambda_closure_indices[state];
+        if (closure_index != trivial_closure &&
+            is_closure_changed[closure_index]) {
+            changed_states.insert(state);
+        }
+    }
+    return changed_states;
+}
+
+void LNFA::add_lambda_closure(IndexType state,
+                              StateSet::WordType *mask) const {
+    auto closure_index = lambda_closure_indices[state];
+    if (closure_index == trivial_closure) {
+        auto bit = StateSet::WordType(1) << (state % StateSet::word_bits);
+        mask[state / StateSet::word_bits] |= bit;
+        return;
+    }
+
+    const auto &words = lambda_closures[closure_index].get_words();
+    for (std::size_t i = 0; i < words.size(); i++) {
+        mask[i] |= words[i];
+    }
+}
+
+bool LNFA::lambda_closure_contains(IndexType state,
+                                   IndexType other_state) const {
+    auto closure_index = lambda_closure_indices[state];
+    if (closure_index == trivial_closure) {
+        return state == other_state;
+    }
+    return lambda_closures[closure_index].contains(other_state);
+}
+
+const BitsetNFA &LNFA::get_simulation() const {
+    if (!are_lambda_closures_built) {
+        throw std::logic_error("LNFA lambda closures are not built");
+    }
+
+    return *simulation;
+}
+
+bool LNFA::accepts(std::string_view word) const {
+    return get_simulation().accepts(word);
 }
 
 LNFA::Verifier LNFA::create_verifier() const { return Verifier(*this); }
 
+BitsetNFA::Matcher LNFA::create_matcher() const {
+    return BitsetNFA::Matcher(get_simulation());
+}
+
 std::optional<std::vector<LNFA::StateType>>
 LNFA::verify_word(const std::string &word) {
+    build_lambda_closures();
+
+    return create_verifier().verify(word);
+}
+
+std::vector<std::optional<std::vector<LNFA::StateType>>>
+LNFA::verify_batch(std::span<const std::string_view> words,
+                   unsigned thread_count) const {
+    std::vector<std::optional<std::vector<StateType>>> results(words.size());
+
+    // Use a few chunks per thread, so that threads which get easy words do
+    // not idle.
+    parallel_for_chunks(
+        words.size(), 4 * thread_count, thread_count,
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            Verifier verifier(*this);
+            for (auto i = begin; i < end; i++) {
+                results[i] = verifier.verify(words[i]);
+            }
+        });
+
+    return results;
+}
+
+DFA LNFA::to_dfa(std::ostream *log, unsigned thread_count) const {
+    // The simulation's successors already fold in the lambda closures
+    return build_subset_dfa(get_simulation(), log, thread_count);
+}
+
+NFA LNFA::remove_lambdas() const {
     if (!are_lambda_closures_built) {
-        build_lambda_closures();
-        are_lambda_closures_built = true;
+        throw std::logic_error("LNFA lambda closures are not built");
     }
 
-    auto verifier = create_verifier();
+    const auto &graph = transition_graph;
+    const auto state_count = graph.get_state_count();
 
-    auto symbol_iter = word.begin();
-    while (symbol_iter != word.end() - 1) {
-        verifier.advance(*symbol_iter);
-        symbol_iter++;
-    }
-    if (symbol_iter != word.end()) {
-        // For the last symbol in word, stop processing when as soon as a final
-        // state is reached.
-        auto is_word_valid = verifier.advance(*symbol_iter, true);
+    auto for_each_in_closure = [&](IndexType state, auto &&fn) {
+        auto closure_index = lambda_closure_indices[state];
+        if (closure_index == trivial_closure) {
+            fn(state);
+        } else {
+            lambda_closures[closure_index].for_each(fn);
+        }
+    };
 
-        if (is_word_valid) {
-            return verifier.build_chain();
+    // Fold closures into the transitions of the states reachable from the
+    // initial state, which are found along the way.
+    struct FoldedTransition {
+        IndexType src_state;
+        IndexType dest_state;
+        TransitionGraph::SymbolType symbol;
+    };
+    std::vector<bool> was_final(state_count, false);
+    for (auto state : final_states) {
+        auto index = graph.find_state(state);
+        if (index != TransitionGraph::no_state) {
+            was_final[index] = true;
         }
     }
 
-    return {};
-}
+    std::vector<FoldedTransition> folded_transitions;
+    std::vector<bool> is_reachable(state_count, false);
+    std::vector<bool> is_final(state_count, false);
+    std::vector<IndexType> reachable_states{graph.find_state(initial_state)};
+    is_reachable[reachable_states.front()] = true;
+
+    for (std::size_t i = 0; i < reachable_states.size(); i++) {
+        auto src_state = reachable_states[i];
+        for_each_in_closure(src_state, [&](std::size_t closure_state) {
+            if (was_final[closure_state]) {
+                is_final[src_state] = true;
+            }
+
+            for (auto edge : graph.get_edges(closure_state)) {
+                if (edge.symbol == TransitionGraph::lambda_symbol) {
+                    // λ-edges are sorted last
+                    break;
+                }
 
-LNFA::Verifier::Verifier(const LNFA &lnfa) {
-    this->lnfa = std::make_shared<LNFA>(lnfa);
-
-    // Start with the initial state's lambda closure
-    for (auto state : lnfa.lambda_closures.at(lnfa.initial_state)) {
-        decltype(QueuedState::origin) origin = {};
-        if (state != lnfa.initial_state) {
-            origin = 0;
-        }
-        state_queue.push_back({state, origin});
-    }
-    queue_index = 0;
-}
-
-bool LNFA::Verifier::advance(SymbolType symbol, bool stop_at_final_state) {
-    bool has_reached_final_state = false;
-
-    auto queued_state_count = state_queue.size();
-    while (queue_index < queued_state_count) {
-        // Process the new states in the queue
-        auto current_state = state_queue[queue_index];
-        const auto &symbol_map = lnfa->transition_map.at(current_state.state);
-
-        try {
-            // For each state reachable from the current state via the symbol...
-            const auto &next_states = symbol_map.at(symbol);
-            for (auto reachable_state : next_states) {
-                const auto &lambda_closure =
-                    lnfa->lambda_closures.at(reachable_state);
-
-                // Queue the state's lambda closure (including the state itself)
-                auto reachable_state_index = queue_index;
-                for (auto lambda_state : lambda_closure) {
-                    // The origin is the current state for the reachable state
-                    // itself, and the reachable state for the other states in
-                    // the closure.
-                    auto origin = reachable_state_index;
-                    if (lambda_state == reachable_state) {
-                        // Store the index of the reachable_state, to use as
-                        // origin when pushing lambda_states.
-                        reachable_state_index = state_queue.size();
-                        origin = queue_index;
-                    }
-                    state_queue.push_back({lambda_state, origin});
-
-                    // Stop at the first reached final state if flag is set
-                    has_reached_final_state |=
-                        lnfa->final_states.contains(lambda_state);
-                    if (stop_at_final_state && has_reached_final_state) {
-                        return true;
-                    }
+                folded_transitions.push_back(
+                    {src_state, edge.dest, edge.symbol});
+                if (!is_reachable[edge.dest]) {
+                    is_reachable[edge.dest] = true;
+                    reachable_states.push_back(edge.dest);
                 }
             }
-        } catch (std::out_of_range &exception) {
-            // Cannot advance from current_state via the symbol
-            // Skip current_state
+        });
+    }
+
+    // Keep the reachable states from which a final state is reachable,
+    // found backwards from the final states.
+    std::vector<IndexType> inverse_begin(state_count + 1, 0);
+    for (const auto &transition : folded_transitions) {
+        inverse_begin[transition.dest_state + 1]++;
+    }
+    for (std::size_t state = 0; state < state_count; state++) {
+        inverse_begin[state + 1] += inverse_begin[state];
+    }
+    std::vector<IndexType> inverse_sources(folded_transitions.size());
+    {
+        auto next_slot = inverse_begin;
+        for (const auto &transition : folded_transitions) {
+            inverse_sources[next_slot[transition.dest_state]++] =
+                transition.src_state;
+        }
+    }
+
+    std::vector<bool> is_useful(state_count, false);
+    std::vector<IndexType> useful_states;
+    for (auto state : reachable_states) {
+        if (is_final[state]) {
+            is_useful[state] = true;
+            useful_states.push_back(state);
+        }
+    }
+    for (std::size_t i = 0; i < useful_states.size(); i++) {
+        auto dest_state = useful_states[i];
+        for (auto j = inverse_begin[dest_state];
+             j < inverse_begin[dest_state + 1]; j++) {
+            auto src_state = inverse_sources[j];
+            if (!is_useful[src_state]) {
+                is_useful[src_state] = true;
+                useful_states.push_back(src_state);
+            }
         }
-        queue_index++;
     }
 
-    return has_reached_final_state;
+    // The initial state is kept even if the language is empty
+    NFA nfa;
+    for (auto state : reachable_states) {
+        if (is_useful[state] || state == reachable_states.front()) {
+            nfa.add_state(graph.get_state_name(state));
+        }
+    }
+    for (const auto &transition : folded_transitions) {
+        if (is_useful[transition.src_state] &&
+            is_useful[transition.dest_state]) {
+            nfa.add_transition(
+                graph.get_state_name(transition.src_state),
+                graph.get_state_name(transition.dest_state),
+                TransitionGraph::to_char(transition.symbol));
+        }
+    }
+    nfa.set_initial_state(initial_state);
+    for (auto state : reachable_states) {
+        if (is_final[state]) {
+            nfa.add_final_state(graph.get_state_name(state));
+        }
+    }
+
+    nfa.freeze();
+    return nfa;
 }
 
-std::vector<LNFA::StateType> LNFA::Verifier::build_chain() const {
-    return build_state_chain<LNFA::StateType>(state_queue);
+LNFA::Verifier::Verifier(const LNFA &lnfa)
+    : lnfa(&lnfa), run(lnfa.get_simulation(), true) {}
+
+std::optional<std::vector<LNFA::StateType>>
+LNFA::Verifier::verify(std::string_view word) {
+    run.reset();
+    for (auto symbol : word) {
+        if (!run.advance(symbol)) {
+            return {};
+        }
+    }
+
+    if (run.is_accepting()) {
+        return build_chain(word);
+    }
+
+    return {};
 }
 
-std::istream &operator>>(std::istream &is, LNFA &lnfa) {
-    std::size_t state_count;
+std::vector<LNFA::StateType>
+LNFA::Verifier::build_chain(std::string_view word) const {
+    const auto &graph = lnfa->transition_graph;
+    auto trace = run.build_trace();
+
+    // Every traced state was reached via lambda from the initial state, or
+    // from a state reached via the symbol. Insert that state before it. The
+    // simulation numbers states like the graph.
+    std::vector<StateType> chain{lnfa->initial_state};
+    auto first_state = graph.get_state_name(trace.front());
+    if (first_state != lnfa->initial_state) {
+        chain.push_back(first_state);
+    }
+
+    for (std::size_t i = 1; i < trace.size(); i++) {
+        auto dest_state = trace[i];
+
+        auto next_edges = graph.get_edges(
+            trace[i - 1], TransitionGraph::to_symbol(word[i - 1]));
+        auto reachable_state =
+            std::ranges::find_if(next_edges, [&](auto edge) {
+                return lnfa->lambda_closure_contains(edge.dest, dest_state);
+            })->dest;
+
+        chain.push_back(graph.get_state_name(reachable_state));
+        if (dest_state != reachable_state) {
+            chain.push_back(graph.get_state_name(dest_state));
+        }
+    }
+
+    // Chains start from the last reached state
+    std::ranges::reverse(chain);
+    return chain;
+}
+
+template <typename Input>
+static Input &read_lnfa(Input &is, LNFA &lnfa) {
+    AUTOMATA_STATS_PHASE(parse);
+    std::size_t state_count = 0;
     is >> state_count;
     for (std::size_t i = 0; i < state_count; i++) {
         int state;
-        is >> state;
+        if (!(is >> state)) {
+            break;
+        }
         lnfa.add_state(state);
     }
 
-    std::size_t transition_count;
+    std::size_t transition_count = 0;
     is >> transition_count;
     for (std::size_t i = 0; i < transition_count; i++) {
         int src_state, dest_state;
         char symbol;
-        is >> src_state >> dest_state >> symbol;
+        if (!(is >> src_state >> dest_state >> symbol)) {
+            break;
+        }
 
         if (symbol == '_') {
             // λ-transition
@@ -156,17 +511,57 @@ std::istream &operator>>(std::istream &is, LNFA &lnfa) {
         }
     }
 
-    int initial_state;
+    int initial_state = 0;
     is >> initial_state;
     lnfa.set_initial_state(initial_state);
 
-    std::size_t final_state_count;
+    std::size_t final_state_count = 0;
     is >> final_state_count;
     for (std::size_t i = 0; i < final_state_count; i++) {
         int final_state;
-        is >> final_state;
+        if (!(is >> final_state)) {
+            break;
+        }
         lnfa.add_final_state(final_state);
     }
 
+    lnfa.build_lambda_closures();
+
     return is;
 }
+
+std::istream &operator>>(std::istream &is, LNFA &lnfa) {
+    return read_lnfa(is, lnfa);
+}
+
+TextReader &operator>>(TextReader &reader, LNFA &lnfa) {
+    return read_lnfa(reader, lnfa);
+}
+
+std::ostream &operator<<(std::ostream &os, const LNFA &lnfa) {
+    os << "LNFA: s = " << lnfa.initial_state << ", F = " << lnfa.final_states
+       << '\n';
+
+    const auto &graph = lnfa.get_frozen_graph();
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        auto edges = graph.get_edges(state);
+        while (!edges.empty()) {
+            // Destinations of one symbol are adjacent
+            auto symbol = edges.front().symbol;
+            std::vector<LNFA::StateType> dest_states;
+            for (; !edges.empty() && edges.front().symbol == symbol;
+                 edges = edges.subspan(1)) {
+                dest_states.push_back(graph.get_state_name(edges.front().dest));
+            }
+
+            // λ-transitions are written as in the input
+            os << graph.get_state_name(state) << " --"
+               << (symbol == TransitionGraph::lambda_symbol
+                       ? '_'
+                       : TransitionGraph::to_char(symbol))
+               << "--> " << dest_states << '\n';
+        }
+    }
+
+    return os;
+}
@@ -1,48 +1,144 @@
 #pragma once
 
 #include "automaton.hpp"
+#include "bitset_nfa.hpp"
+#include "text_reader.hpp"
 #include <istream>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+class DFA;
+class NFA;
 
 class LNFA : public Automaton {
 public:
     using SymbolType = std::optional<char>;
 
 private:
-    using SymbolMap = std::unordered_map<SymbolType, std::vector<StateType>>;
-    using TransitionMap = std::unordered_map<StateType, SymbolMap>;
-    TransitionMap transition_map;
+    using IndexType = TransitionGraph::IndexType;
+
+    // Closure of a state which only reaches itself via lambda
+    static constexpr IndexType trivial_closure = UINT32_MAX;
 
     bool are_lambda_closures_built = false;
-    std::unordered_map<StateType, std::unordered_set<StateType>>
-        lambda_closures;
+    // The states of a strongly connected component of the λ-edges share a
+    // closure, so closures are kept once per component, as bitsets over
+    // graph indices. Every state has the index of its closure, or
+    // trivial_closure.
+    std::vector<IndexType> lambda_closure_indices;
+    std::vector<StateSet> lambda_closures;
+    // λ-edges added since the closures were computed, as graph indices
+    std::vector<std::pair<IndexType, IndexType>> pending_lambda_edges;
+    // Sources of the other edges added since then
+    std::vector<IndexType> pending_sources;
+
+    // Compute every closure via Tarjan's algorithm
+    void compute_lambda_closures();
+    // Add new states and pending λ-edges to the closures. Returns the
+    // states whose closure changed.
+    StateSet update_lambda_closures();
+
+    void add_lambda_closure(IndexType state, StateSet::WordType *mask) const;
+    // Call fn for every state in the lambda closure of state
+    template <typename Fn>
+    void for_each_in_lambda_closure(IndexType state, Fn &&fn) const {
+        auto closure_index = lambda_closure_indices[state];
+        if (closure_index == trivial_closure) {
+            fn(state);
+            return;
+        }
+        lambda_closures[closure_index].for_each(fn);
+    }
+    [[nodiscard]] bool lambda_closure_contains(IndexType state,
+                                               IndexType other_state) const;
+
+    // Simulation tables, built along with the lambda closures, and updated
+    // in place when possible.
+    std::shared_ptr<BitsetNFA> simulation;
 
+    void invalidate_caches() override;
+
+    const BitsetNFA &get_simulation() const;
+
+public:
+    /**
+     * Verifies words against a borrowed LNFA, whose lambda closures must
+     * already be built. The LNFA is never copied or modified, so a verifier
+     * can be reused for many words, and several verifiers can share the same
+     * LNFA across threads.
+     */
     class Verifier {
     private:
-        std::shared_ptr<const LNFA> lnfa;
-        std::vector<QueuedState> state_queue;
-        std::size_t queue_index;
+        const LNFA *lnfa;
+        BitsetNFA::Run run;
 
-    public:
-        Verifier(const LNFA &lnfa);
+        // Expand the run's trace with the states passed through via lambda.
+        std::vector<StateType> build_chain(std::string_view word) const;
 
-        // Advance from current states via symbol.
-        // Returns true if any of the reached states is final.
-        bool advance(SymbolType symbol, bool stop_at_final_state = false);
+    public:
+        explicit Verifier(const LNFA &lnfa);
 
-        std::vector<StateType> build_chain() const;
+        std::optional<std::vector<StateType>> verify(std::string_view word);
     };
 
     Verifier create_verifier() const;
 
+    /**
+     * Matcher for chunked input, valid until the LNFA is modified. Requires
+     * the lambda closures to be built.
+     */
+    BitsetNFA::Matcher create_matcher() const;
+
+    /**
+     * Freeze the LNFA, and build the lambda closures and simulation tables
+     * needed for verifying words. Must be called again after modifying the
+     * LNFA. Closures are only computed in full the first time. Afterwards,
+     * new states and λ-transitions are added to them, and only the
+     * simulation tables of states whose successors changed are rebuilt.
+     */
     void build_lambda_closures();
 
-public:
+    /** Check if the word is accepted, without building a state chain. */
+    [[nodiscard]] bool accepts(std::string_view word) const;
+
     void add_state(StateType state) override;
     void add_transition(StateType src_state, StateType dest_state,
                         SymbolType symbol);
     std::optional<std::vector<StateType>>
     verify_word(const std::string &word) override;
+
+    /**
+     * Verify many words on up to thread_count threads, sharing this LNFA.
+     * Results are in the same order as the words.
+     */
+    [[nodiscard]] std::vector<std::optional<std::vector<StateType>>>
+    verify_batch(std::span<const std::string_view> words,
+                 unsigned thread_count = 1) const;
+
+    /**
+     * Determinize via subset construction, starting from the initial state's
+     * lambda closure and following lambda closures after every symbol, on up
+     * to thread_count threads. If log is given, every new combined state is
+     * written to it.
+     */
+    [[nodiscard]] DFA to_dfa(std::ostream *log = nullptr,
+                             unsigned thread_count = 1) const;
+
+    /**
+     * An NFA with the same language and no λ-transitions. Every state gets
+     * the symbol transitions of the states in its lambda closure, and is
+     * final if its closure holds a final state. States which are then
+     * unreachable, or from which no final state can be reached, are
+     * dropped. Requires the lambda closures to be built.
+     */
+    [[nodiscard]] NFA remove_lambdas() const;
+
+    friend class BitsetNFA;
+    friend std::ostream &operator<<(std::ostream &os, const LNFA &lnfa);
 };
 
-/** Read an NFA from a istream. */
+/** Read an LNFA from a istream or text, with its lambda closures built. */
 std::istream &operator>>(std::istream &is, LNFA &lnfa);
+TextReader &operator>>(TextReader &reader, LNFA &lnfa);
+std::ostream &operator<<(std::ostream &os, const LNFA &lnfa);
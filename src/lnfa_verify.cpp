@@ -1,41 +1,133 @@
-#include <fstream>
+#include <charconv>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
 
 #include "lnfa.hpp"
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
+
+// Words are verified in blocks, so that buffered output stays bounded.
+constexpr std::size_t block_size = 1 << 20;
+
+static void append_result(
+    std::string &output, std::string_view word,
+    const std::optional<std::vector<LNFA::StateType>> &result) {
+    output += word;
+    output += ' ';
+    if (result.has_value()) {
+        auto &chain = result.value();
+        output += "DA:";
+        for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+            char buffer[16];
+            auto end = std::to_chars(buffer, buffer + sizeof(buffer), *it).ptr;
+            output += " -> ";
+            output.append(buffer, end);
+        }
+    } else {
+        output += "NU";
+    }
+    output += '\n';
+}
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
+    // Pass --stats to write statistics as JSON to stderr at the end
+    bool print_stats = false;
+    const char *input_path = nullptr;
+    const char *thread_count_arg = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "--stats") {
+            print_stats = true;
+        } else if (input_path == nullptr) {
+            input_path = argv[i];
+        } else {
+            thread_count_arg = argv[i];
+        }
+    }
+    if (input_path == nullptr) {
         return 1;
     }
 
-    std::ifstream ifs(argv[1]);
+    unsigned thread_count = get_default_thread_count();
+    if (thread_count_arg != nullptr) {
+        std::string_view arg(thread_count_arg);
+        auto [end, error] =
+            std::from_chars(arg.data(), arg.data() + arg.size(), thread_count);
+        if (error != std::errc() || end != arg.data() + arg.size() ||
+            thread_count == 0) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--stats] <input> [thread_count]\n";
+            return 1;
+        }
+    }
+
+    // Words are views into the mapped file, which outlives them
+    std::optional<MappedFile> file;
+    try {
+        file.emplace(input_path);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    TextReader reader(file->get_contents());
 
     LNFA lnfa;
-    ifs >> lnfa;
+    if (!(reader >> lnfa)) {
+        std::cerr << "Could not parse " << input_path << '\n';
+        return 1;
+    }
 
     // Start verifying words
-    std::size_t word_count;
-    ifs >> word_count;
-
-    for (std::size_t i = 0; i < word_count; i++) {
-        std::string word;
-        ifs >> word;
-
-        auto result = lnfa.verify_word(word);
-        std::cout << word << ' ';
-        if (result.has_value()) {
-            auto &chain = result.value();
-            std::cout << "DA:";
-            for (auto it = chain.rbegin(); it != chain.rend(); it++) {
-                std::cout << " -> " << *it;
+    std::size_t word_count = 0;
+    if (!(reader >> word_count)) {
+        std::cerr << "Could not read the word count from " << input_path
+                  << '\n';
+        return 1;
+    }
+
+    std::vector<std::string_view> words;
+    const std::size_t chunk_count = 4 * thread_count;
+    std::vector<std::string> outputs(chunk_count);
+
+    for (std::size_t block_begin = 0; block_begin < word_count;
+         block_begin += block_size) {
+        const auto block_end = std::min(block_begin + block_size, word_count);
+        words.clear();
+        for (auto i = block_begin; i < block_end; i++) {
+            std::string_view word;
+            if (!(reader >> word)) {
+                std::cerr << "Expected " << word_count << " words in "
+                          << input_path << ", found " << i << '\n';
+                return 1;
             }
-        } else {
-            std::cout << "NU";
+            words.push_back(word);
+        }
+
+        // Every chunk of words is verified on some thread into its own
+        // buffer, and the buffers are written in input order.
+        AUTOMATA_STATS_PHASE(matching);
+        parallel_for_chunks(
+            words.size(), chunk_count, thread_count,
+            [&](std::size_t chunk_index, std::size_t begin, std::size_t end) {
+                LNFA::Verifier verifier(lnfa);
+                auto &output = outputs[chunk_index];
+                for (auto i = begin; i < end; i++) {
+                    append_result(output, words[i], verifier.verify(words[i]));
+                }
+            });
+
+        AUTOMATA_STATS_PHASE(output);
+        for (auto &output : outputs) {
+            std::cout << output;
+            output.clear();
         }
-        std::cout << '\n';
     }
 
-    ifs.close();
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
 
     return 0;
 }
@@ -0,0 +1,47 @@
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+MappedFile::MappedFile(const std::string &path, Access access) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        auto error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+    size = file_stat.st_size;
+
+    // Empty files cannot be mapped, but have nothing to map anyway.
+    if (size > 0) {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            auto error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+
+        madvise(mapping, size,
+                access == Access::sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        data = static_cast<const char *>(mapping);
+    }
+
+    // The mapping stays valid after closing the file
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(const_cast<char *>(data), size);
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/** A read-only memory mapping of a whole file. */
+class MappedFile {
+public:
+    /** Expected access pattern, passed on to the kernel. */
+    enum class Access { sequential, random };
+
+private:
+    const char *data = nullptr;
+    std::size_t size = 0;
+
+public:
+    /** Map the file at path. Throws std::system_error on failure. */
+    explicit MappedFile(const std::string &path,
+                        Access access = Access::sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] std::string_view get_contents() const { return {data, size}; }
+};
@@ -1,21 +1,167 @@
+#include <cctype>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
 
+#include "codegen.hpp"
 #include "dfa.hpp"
+#include "dfa_cache.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
+
+static bool save_compiled(const CompiledDFA &compiled,
+                          const char *output_path) {
+    AUTOMATA_STATS_PHASE(output);
+    std::ofstream ofs(output_path, std::ios::binary);
+    compiled.save(ofs);
+    if (!ofs) {
+        std::cerr << "Could not write " << output_path << '\n';
+        return false;
+    }
+    return true;
+}
+
+// A C++ identifier made from the file name of path, with a trailing
+// underscore if it is a keyword
+static std::string get_identifier(const char *path) {
+    auto identifier = std::filesystem::path(path).stem().string();
+    for (auto &character : identifier) {
+        if (!std::isalnum(static_cast<unsigned char>(character))) {
+            character = '_';
+        }
+    }
+    if (identifier.empty() ||
+        std::isdigit(static_cast<unsigned char>(identifier.front()))) {
+        identifier.insert(0, "_");
+    }
+    if (!is_identifier(identifier)) {
+        // A keyword, like int for int.hpp
+        identifier += '_';
+    }
+    return identifier;
+}
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
+    // Pass --stats to write statistics as JSON to stderr at the end. With
+    // --cache DIR, minimized DFAs are kept in a DFACache in DIR, along with
+    // the fingerprint of their language, which is also written. An input
+    // which was minimized before is not read again: its cached report is
+    // written, and the cached compiled DFA is copied to the output. With
+    // --header PATH, the minimized DFA is also written to PATH as a C++
+    // header defining a constexpr StaticDFA named after the file, which
+    // always needs the input to be read.
+    bool print_stats = false;
+    const char *cache_path = nullptr;
+    const char *header_path = nullptr;
+    const char *input_path = nullptr;
+    const char *output_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "--stats") {
+            print_stats = true;
+        } else if (std::string_view(argv[i]) == "--cache" && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else if (std::string_view(argv[i]) == "--header" && i + 1 < argc) {
+            header_path = argv[++i];
+        } else if (input_path == nullptr) {
+            input_path = argv[i];
+        } else {
+            output_path = argv[i];
+        }
+    }
+    if (input_path == nullptr) {
         return 1;
     }
 
-    std::ifstream ifs(argv[1]);
+    std::optional<MappedFile> file;
+    std::optional<DFACache> cache;
+    try {
+        file.emplace(input_path);
+        if (cache_path != nullptr) {
+            cache.emplace(cache_path);
+        }
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    Fingerprint input_key;
+    if (cache.has_value()) {
+        FingerprintBuilder builder;
+        builder.add("minimize_dfa");
+        builder.add(file->get_contents());
+        input_key = builder.finish();
+
+        auto entry = cache->find_input(input_key);
+        auto compiled = entry.has_value() ? cache->find(entry->fingerprint)
+                                          : std::nullopt;
+        if (compiled.has_value() && header_path == nullptr) {
+            std::cout << entry->report;
+            if (output_path != nullptr &&
+                !save_compiled(compiled.value(), output_path)) {
+                return 1;
+            }
+            if (print_stats) {
+                stats::write_json(std::cerr);
+            }
+            return 0;
+        }
+    }
+
+    TextReader reader(file->get_contents());
 
     DFA dfa;
-    ifs >> dfa;
+    if (!(reader >> dfa)) {
+        std::cerr << "Could not parse " << input_path << '\n';
+        return 1;
+    }
 
-    std::cout << "Initial " << dfa << '\n';
+    // With a cache, the report is kept, to be written again on a hit
+    std::ostringstream cached_report;
+    std::ostream &report = cache.has_value() ? cached_report : std::cout;
+    {
+        AUTOMATA_STATS_PHASE(output);
+        report << "Initial " << dfa << '\n';
+    }
 
-    std::cout << "Minimized "<< dfa.minimize() << '\n';
+    auto minimized = dfa.minimize();
+    {
+        AUTOMATA_STATS_PHASE(output);
+        report << "Minimized " << minimized << '\n';
+    }
+
+    if (cache.has_value()) {
+        DFACache::InputEntry entry{minimized.fingerprint_minimized(), {}};
+        report << "Fingerprint " << entry.fingerprint.to_string() << '\n';
+        entry.report = cached_report.str();
+        cache->store(entry.fingerprint, minimized.compile());
+        cache->store_input(input_key, entry);
+        std::cout << entry.report;
+    }
+
+    if (header_path != nullptr) {
+        AUTOMATA_STATS_PHASE(output);
+        std::ofstream ofs(header_path);
+        write_static_dfa_header(ofs, minimized, get_identifier(header_path));
+        if (!ofs) {
+            std::cerr << "Could not write " << header_path << '\n';
+            return 1;
+        }
+    }
+
+    if (output_path != nullptr) {
+        // Also save the compiled minimized DFA, for dfa_verify
+        if (!save_compiled(minimized.compile(), output_path)) {
+            return 1;
+        }
+    }
+
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
 
     return 0;
 }
@@ -1,232 +1,153 @@
 #include <algorithm>
-#include <bits/ranges_algo.h>
-#include <iostream>
-#include <numeric>
-#include <queue>
-#include <ranges>
-#include <unordered_set>
+#include <array>
+#include <istream>
+#include <ostream>
 
 #include "dfa.hpp"
+#include "language_checks.hpp"
 #include "nfa.hpp"
+#include "stats.hpp"
+#include "subset_construction.hpp"
 #include "utils.hpp"
 
-template <> struct std::hash<std::vector<int>> {
-public:
-    std::size_t operator()(const std::vector<int> &vec) const {
-        std::size_t seed = vec.size();
-        for (auto &i : vec) {
-            seed ^= i + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
-    }
-};
+void NFA::invalidate_caches() { simulation.reset(); }
 
-void NFA::add_state(StateType state) { transition_map[state] = SymbolMap(); }
+void NFA::add_state(StateType state) {
+    transition_graph.add_state(state);
+    invalidate_caches();
+}
 
 void NFA::add_transition(StateType src_state, StateType dest_state,
                          SymbolType symbol) {
-    transition_map[src_state][symbol].push_back(dest_state);
+    transition_graph.add_transition(src_state, dest_state,
+                                    TransitionGraph::to_symbol(symbol));
+    invalidate_caches();
 }
 
-std::optional<std::vector<NFA::StateType>>
-NFA::verify_word(const std::string &word) {
-    std::vector<QueuedState> current_states;
-    current_states.push_back({initial_state, {}});
-    std::size_t queue_index = 0;
-
-    for (std::string::size_type i = 0; i < word.size(); i++) {
-        // Stop processing for the last symbol in word
-        bool stop_at_final_state = i == word.size() - 1;
-        auto symbol = word.at(i);
-        // Advance from each current state using the symbol
-        auto current_states_count = current_states.size();
-        for (; queue_index < current_states_count; queue_index++) {
-            auto queued_state = current_states[queue_index];
-            try {
-                auto next_states =
-                    transition_map.at(queued_state.state).at(symbol);
-                for (auto state : next_states) {
-                    current_states.push_back({state, queue_index});
-                    if (stop_at_final_state && final_states.contains(state)) {
-                        return build_state_chain<StateType>(current_states);
-                    }
-                }
-            } catch (std::out_of_range &exception) {
-            }
+std::vector<NFA::SymbolType> NFA::get_alphabet() const {
+    const auto &graph = get_frozen_graph();
+    std::array<bool, 256> is_used{};
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        for (auto edge : graph.get_edges(state)) {
+            is_used[edge.symbol] = true;
         }
     }
 
-    // Reached states are in current_states[queue_index:]
-    // Return true if any of the reached states are final
-    for (; queue_index < current_states.size(); queue_index++) {
-        auto reached_state = current_states[queue_index];
-        if (final_states.contains(reached_state.state)) {
-            return build_state_chain<StateType>(current_states);
+    std::vector<SymbolType> alphabet;
+    for (std::size_t symbol = 0; symbol < is_used.size(); symbol++) {
+        if (is_used[symbol]) {
+            alphabet.push_back(TransitionGraph::to_char(symbol));
         }
     }
-
-    return {};
+    return alphabet;
 }
 
-DFA NFA::to_dfa() const {
-    DFA dfa;
-
-    dfa.initial_state = initial_state;
-
-    StateType available_state_name =
-        1 + std::accumulate(transition_map.begin(), transition_map.end(),
-                            initial_state, [](StateType max_state, auto state) {
-                                return std::max(max_state, state.first);
-                            });
-
-    std::unordered_map<StateType, std::vector<StateType>> combination_of;
-    std::unordered_map<std::vector<StateType>, StateType>
-        composing_states_to_state_map;
-
-    std::queue<StateType> state_queue;
-    state_queue.push(initial_state);
-
-    auto queue_new_combined_state =
-        [&](const std::vector<StateType> &composing_states) {
-            StateType new_state;
-            if (composing_states.size() == 1) {
-                // Destination state is probably one of the NFA's states.
-                // Reuse the name.
-                new_state = composing_states.front();
-            } else {
-                new_state = available_state_name++;
-
-                std::cerr << "New state " << new_state << " = "
-                          << composing_states << '\n';
-            }
-
-            combination_of[new_state] = composing_states;
-            composing_states_to_state_map[composing_states] = new_state;
-
-            dfa.add_state(new_state);
-
-            if (std::ranges::any_of(composing_states, [&](StateType state) {
-                    return final_states.contains(state);
-                })) {
-                // New state contains a final state from the NFA
-                dfa.add_final_state(new_state);
-            }
-
-            state_queue.push(new_state);
-
-            return new_state;
-        };
-
-    auto add_dfa_transition = [&](StateType src_state,
-                                  const std::vector<StateType> &dest_states,
-                                  SymbolType symbol) {
-        // Check if combined state exists
-        auto existing_state = composing_states_to_state_map.find(dest_states);
-        if (existing_state == composing_states_to_state_map.end()) {
-            // New combined state
-            auto new_state = queue_new_combined_state(dest_states);
-
-            // Add it to the transition map
-            dfa.add_transition(src_state, new_state, symbol);
-        } else {
-            // Existing combined state
-            dfa.add_transition(src_state, existing_state->second, symbol);
-        }
-    };
-
-    auto compute_symbol_map_of_sets =
-        [&](const std::vector<StateType> &composing_states) {
-            // Compute union of reached states from every composing state, for
-            // every symbol.
-            std::unordered_map<SymbolType, std::unordered_set<StateType>>
-                symbol_to_states_map;
-            for (const auto composing_state : composing_states) {
-                for (const auto &[symbol, reached_states] :
-                     transition_map.at(composing_state)) {
-                    symbol_to_states_map[symbol].insert(reached_states.begin(),
-                                                        reached_states.end());
-                }
-            }
-
-            return symbol_to_states_map;
-        };
-
-    while (!state_queue.empty()) {
-        auto queued_state = state_queue.front();
-        state_queue.pop();
+const BitsetNFA &NFA::get_simulation() {
+    if (!simulation) {
+        freeze();
+        simulation = std::make_shared<const BitsetNFA>(*this);
+    }
+    return *simulation;
+}
 
-        // Check if queued state is simple or composed of other states
-        auto composing_states_pair = combination_of.find(queued_state);
-        if (composing_states_pair != combination_of.end()) {
-            // Queued state is composed of multiple other states.
-            auto symbol_to_states_map =
-                compute_symbol_map_of_sets(composing_states_pair->second);
+BitsetNFA::Matcher NFA::create_matcher() {
+    return BitsetNFA::Matcher(get_simulation());
+}
 
-            // Add a transition for every symbol in the map.
-            for (const auto &[symbol, reached_states_set] :
-                 symbol_to_states_map) {
-                std::vector<StateType> reached_states_vec(
-                    reached_states_set.begin(), reached_states_set.end());
-                std::ranges::sort(reached_states_vec);
+std::optional<std::vector<NFA::StateType>>
+NFA::verify_word(const std::string &word) {
+    auto trace = get_simulation().trace(word);
+    if (!trace.has_value()) {
+        return {};
+    }
 
-                add_dfa_transition(queued_state, reached_states_vec, symbol);
-            }
-        } else {
-            // Single state
-            dfa.add_state(queued_state);
-            const auto &symbol_map = transition_map.at(queued_state);
+    // Chains start from the last reached state
+    std::ranges::reverse(trace.value());
+    return trace;
+}
 
-            for (auto [symbol, reached_states] : symbol_map) {
-                std::ranges::sort(reached_states);
+DFA NFA::to_dfa(std::ostream *log, unsigned thread_count) const {
+    return build_subset_dfa(BitsetNFA(*this), log, thread_count);
+}
 
-                add_dfa_transition(queued_state, reached_states, symbol);
-            }
-        }
-    }
+bool NFA::is_subset_of(const NFA &other) const {
+    return !find_inclusion_counterexample(other).has_value();
+}
 
-    return dfa;
+std::optional<std::string>
+NFA::find_inclusion_counterexample(const NFA &other) const {
+    return ::find_inclusion_counterexample(BitsetNFA(*this), BitsetNFA(other));
 }
 
-std::istream &operator>>(std::istream &is, NFA &nfa) {
-    std::size_t state_count;
+template <typename Input>
+static Input &read_nfa(Input &is, NFA &nfa) {
+    AUTOMATA_STATS_PHASE(parse);
+    std::size_t state_count = 0;
     is >> state_count;
     for (std::size_t i = 0; i < state_count; i++) {
         NFA::StateType state;
-        is >> state;
+        if (!(is >> state)) {
+            break;
+        }
         nfa.add_state(state);
     }
 
-    std::size_t transition_count;
+    std::size_t transition_count = 0;
     is >> transition_count;
     for (std::size_t i = 0; i < transition_count; i++) {
         NFA::StateType src_state, dest_state;
         char symbol;
-        is >> src_state >> dest_state >> symbol;
+        if (!(is >> src_state >> dest_state >> symbol)) {
+            break;
+        }
         nfa.add_transition(src_state, dest_state, symbol);
     }
 
-    NFA::StateType initial_state;
+    NFA::StateType initial_state = 0;
     is >> initial_state;
     nfa.set_initial_state(initial_state);
 
-    std::size_t final_state_count;
+    std::size_t final_state_count = 0;
     is >> final_state_count;
     for (std::size_t i = 0; i < final_state_count; i++) {
         NFA::StateType final_state;
-        is >> final_state;
+        if (!(is >> final_state)) {
+            break;
+        }
         nfa.add_final_state(final_state);
     }
 
+    nfa.freeze();
     return is;
 }
 
+std::istream &operator>>(std::istream &is, NFA &nfa) {
+    return read_nfa(is, nfa);
+}
+
+TextReader &operator>>(TextReader &reader, NFA &nfa) {
+    return read_nfa(reader, nfa);
+}
+
 std::ostream &operator<<(std::ostream &os, const NFA &nfa) {
     os << "NFA: s = " << nfa.initial_state << ", F = " << nfa.final_states
        << '\n';
 
-    for (const auto &[src_state, symbol_map] : nfa.transition_map) {
-        for (const auto [symbol, dest_states] : symbol_map) {
-            os << src_state << " --" << symbol << "--> " << dest_states << '\n';
+    const auto &graph = nfa.get_frozen_graph();
+    for (std::size_t state = 0; state < graph.get_state_count(); state++) {
+        auto edges = graph.get_edges(state);
+        while (!edges.empty()) {
+            // Destinations of one symbol are adjacent
+            auto symbol = edges.front().symbol;
+            std::vector<NFA::StateType> dest_states;
+            for (; !edges.empty() && edges.front().symbol == symbol;
+                 edges = edges.subspan(1)) {
+                dest_states.push_back(graph.get_state_name(edges.front().dest));
+            }
+
+            os << graph.get_state_name(state) << " --"
+               << TransitionGraph::to_char(symbol) << "--> " << dest_states
+               << '\n';
         }
     }
 
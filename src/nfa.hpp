@@ -1,8 +1,10 @@
 #pragma once
 
 #include "automaton.hpp"
-#include "dfa.hpp"
+#include "bitset_nfa.hpp"
+#include "text_reader.hpp"
 #include <istream>
+#include <ostream>
 
 class DFA;
 
@@ -11,9 +13,10 @@ public:
     using SymbolType = char;
 
 private:
-    using SymbolMap = std::unordered_map<SymbolType, std::vector<StateType>>;
-    using TransitionMap = std::unordered_map<StateType, SymbolMap>;
-    TransitionMap transition_map;
+    // Simulation tables used for verifying words, built on first use.
+    std::shared_ptr<const BitsetNFA> simulation;
+
+    void invalidate_caches() override;
 
 public:
     void add_state(StateType state) override;
@@ -22,10 +25,33 @@ public:
     std::optional<std::vector<StateType>>
     verify_word(const std::string &word) override;
 
-    DFA to_dfa() const;
+    [[nodiscard]] std::vector<SymbolType> get_alphabet() const;
+
+    const BitsetNFA &get_simulation();
+
+    /** Matcher for chunked input, valid until the NFA is modified. */
+    BitsetNFA::Matcher create_matcher();
+
+    /**
+     * Determinize via subset construction, on up to thread_count threads.
+     * If log is given, every new combined state is written to it.
+     */
+    [[nodiscard]] DFA to_dfa(std::ostream *log = nullptr,
+                             unsigned thread_count = 1) const;
+
+    /**
+     * Check if other accepts every word this NFA accepts, without
+     * determinizing either, see find_inclusion_counterexample.
+     */
+    [[nodiscard]] bool is_subset_of(const NFA &other) const;
+    /** A shortest word accepted by this NFA but not by other, if any. */
+    [[nodiscard]] std::optional<std::string>
+    find_inclusion_counterexample(const NFA &other) const;
 
+    friend class BitsetNFA;
     friend std::ostream &operator<<(std::ostream &os, const NFA &nfa);
 };
 
 std::istream &operator>>(std::istream &is, NFA &nfa);
+TextReader &operator>>(TextReader &reader, NFA &nfa);
 std::ostream &operator<<(std::ostream &os, const NFA &nfa);
@@ -1,24 +1,111 @@
-#include <fstream>
+#include <charconv>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 #include "dfa.hpp"
+#include "lnfa.hpp"
+#include "mapped_file.hpp"
 #include "nfa.hpp"
+#include "regex.hpp"
+#include "stats.hpp"
+
+template <typename AutomatonT>
+static AutomatonT read_automaton(const char *path) {
+    MappedFile file(path);
+    TextReader reader(file.get_contents());
+
+    AutomatonT automaton;
+    if (!(reader >> automaton)) {
+        throw std::runtime_error(std::string("Could not parse ") + path);
+    }
+    return automaton;
+}
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
+    // Pass -v to log every new combined state to stderr, -l to read an
+    // LNFA, with λ-transitions written as '_', and -j N to determinize on N
+    // threads. With -e PATTERN, the automaton is built from a regular
+    // expression instead of read from a file: a Glushkov NFA, or a Thompson
+    // LNFA with -l. Pass --stats to write statistics as JSON to stderr at
+    // the end.
+    bool is_verbose = false;
+    bool print_stats = false;
+    bool has_lambdas = false;
+    unsigned thread_count = 1;
+    const char *input_path = nullptr;
+    const char *pattern = nullptr;
+    bool is_usage_error = false;
+    for (int i = 1; i < argc && !is_usage_error; i++) {
+        std::string_view arg(argv[i]);
+        if (arg == "-v") {
+            is_verbose = true;
+        } else if (arg == "-l") {
+            has_lambdas = true;
+        } else if (arg == "-j" && i + 1 < argc) {
+            std::string_view count(argv[++i]);
+            auto [end, error] = std::from_chars(
+                count.data(), count.data() + count.size(), thread_count);
+            is_usage_error = error != std::errc() ||
+                             end != count.data() + count.size() ||
+                             thread_count == 0;
+        } else if (arg == "-e" && i + 1 < argc) {
+            pattern = argv[++i];
+        } else if (arg == "--stats") {
+            print_stats = true;
+        } else if (arg.starts_with('-')) {
+            // An unknown flag, or one missing its value
+            is_usage_error = true;
+        } else {
+            input_path = argv[i];
+        }
+    }
+    if (is_usage_error || (input_path == nullptr && pattern == nullptr)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-v] [-l] [-j thread_count] [--stats]"
+                     " (<input> | -e <pattern>)\n";
         return 1;
     }
 
-    std::ifstream ifs(argv[1]);
+    auto *log = is_verbose ? &std::cerr : nullptr;
+    DFA dfa;
+    // Missing files, bad input and bad patterns are reported
+    try {
+        if (has_lambdas) {
+            auto lnfa = pattern != nullptr ? regex_to_lnfa(pattern)
+                                           : read_automaton<LNFA>(input_path);
 
-    NFA nfa;
-    ifs >> nfa;
+            {
+                AUTOMATA_STATS_PHASE(output);
+                std::cout << lnfa << '\n';
+            }
 
-    std::cout << nfa << '\n';
+            dfa = lnfa.to_dfa(log, thread_count);
+        } else {
+            auto nfa = pattern != nullptr ? regex_to_nfa(pattern)
+                                          : read_automaton<NFA>(input_path);
 
-    DFA dfa(nfa.to_dfa());
+            {
+                AUTOMATA_STATS_PHASE(output);
+                std::cout << nfa << '\n';
+            }
 
-    std::cout << dfa << '\n';
+            dfa = nfa.to_dfa(log, thread_count);
+        }
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+
+    {
+        AUTOMATA_STATS_PHASE(output);
+        std::cout << dfa << '\n';
+    }
+
+    if (print_stats) {
+        stats::write_json(std::cerr);
+    }
 
     return 0;
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * Split [0, count) into chunk_count contiguous chunks of about equal size and
+ * call fn(chunk_index, begin, end) once for every chunk. Chunks are handed
+ * out to up to thread_count threads as they become idle.
+ */
+template <typename Fn>
+void parallel_for_chunks(std::size_t count, std::size_t chunk_count,
+                         unsigned thread_count, Fn &&fn) {
+    chunk_count = std::max<std::size_t>(1, std::min(chunk_count, count));
+    auto chunk_begin = [&](std::size_t chunk_index) {
+        return count * chunk_index / chunk_count;
+    };
+
+    std::atomic<std::size_t> next_chunk = 0;
+    auto worker = [&]() {
+        for (auto chunk_index = next_chunk++; chunk_index < chunk_count;
+             chunk_index = next_chunk++) {
+            fn(chunk_index, chunk_begin(chunk_index),
+               chunk_begin(chunk_index + 1));
+        }
+    };
+
+    thread_count = std::clamp<std::size_t>(thread_count, 1, chunk_count);
+    std::vector<std::jthread> threads;
+    for (unsigned i = 1; i < thread_count; i++) {
+        threads.emplace_back(worker);
+    }
+    // The calling thread works too
+    worker();
+}
+
+/** Number of threads to use when none is requested. */
+inline unsigned get_default_thread_count() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "product_construction.hpp"
+
+namespace {
+
+bool is_accepting(ProductOperation operation, bool is_first_final,
+                  bool is_second_final) {
+    switch (operation) {
+    case ProductOperation::intersect:
+        return is_first_final && is_second_final;
+    case ProductOperation::unite:
+        return is_first_final || is_second_final;
+    case ProductOperation::subtract:
+        return is_first_final && !is_second_final;
+    case ProductOperation::symmetric_difference:
+        return is_first_final != is_second_final;
+    }
+    return false;
+}
+
+// Whether no word can be accepted from the pair, since a dead state cannot
+// accept anymore
+bool is_dead(ProductOperation operation, bool is_first_dead,
+             bool is_second_dead) {
+    switch (operation) {
+    case ProductOperation::intersect:
+        return is_first_dead || is_second_dead;
+    case ProductOperation::subtract:
+        return is_first_dead;
+    case ProductOperation::unite:
+    case ProductOperation::symmetric_difference:
+        return is_first_dead && is_second_dead;
+    }
+    return false;
+}
+
+} // namespace
+
+DFA build_product_dfa(const DFA &first, const DFA &second,
+                      ProductOperation operation) {
+    using IndexType = CompiledDFA::IndexType;
+    constexpr auto dead_state = CompiledDFA::dead_state;
+
+    // The compiled tables have an explicit dead state to pair with
+    const auto first_compiled = first.compile();
+    const auto second_compiled = second.compile();
+
+    auto alphabet = first.get_alphabet();
+    for (auto symbol : second.get_alphabet()) {
+        if (std::ranges::find(alphabet, symbol) == alphabet.end()) {
+            alphabet.push_back(symbol);
+        }
+    }
+    std::ranges::sort(alphabet);
+
+    // Pairs are numbered in BFS order, which is also their state name
+    std::vector<std::pair<IndexType, IndexType>> pairs;
+    std::unordered_map<std::uint64_t, DFA::StateType> pair_names;
+
+    DFA product;
+    auto add_pair = [&](IndexType first_state, IndexType second_state) {
+        auto key = std::uint64_t(first_state) << 32 | second_state;
+        auto [iter, was_inserted] = pair_names.try_emplace(
+            key, static_cast<DFA::StateType>(pairs.size()));
+        if (was_inserted) {
+            pairs.emplace_back(first_state, second_state);
+            product.add_state(iter->second);
+            if (is_accepting(operation, first_compiled.is_final(first_state),
+                             second_compiled.is_final(second_state))) {
+                product.add_final_state(iter->second);
+            }
+        }
+        return iter->second;
+    };
+
+    product.set_initial_state(add_pair(first_compiled.get_initial_state(),
+                                       second_compiled.get_initial_state()));
+
+    for (std::size_t i = 0; i < pairs.size(); i++) {
+        auto [first_state, second_state] = pairs[i];
+        for (auto symbol : alphabet) {
+            auto first_dest = first_compiled.next_state(first_state, symbol);
+            auto second_dest =
+                second_compiled.next_state(second_state, symbol);
+            if (is_dead(operation, first_dest == dead_state,
+                        second_dest == dead_state)) {
+                continue;
+            }
+
+            product.add_transition(static_cast<DFA::StateType>(i),
+                                   add_pair(first_dest, second_dest), symbol);
+        }
+    }
+
+    product.freeze();
+    return product;
+}
+
+DFA build_complement_dfa(const DFA &dfa, std::span<const char> alphabet) {
+    using IndexType = CompiledDFA::IndexType;
+    const auto compiled = dfa.compile();
+
+    // The dead state is the sink, so every compiled state is usable as is.
+    // States are numbered in BFS order.
+    std::vector<IndexType> states{compiled.get_initial_state()};
+    std::vector<DFA::StateType> state_names(compiled.get_state_count(), -1);
+    state_names[states.front()] = 0;
+
+    DFA complement;
+    auto add_state = [&](IndexType state) {
+        auto &name = state_names[state];
+        if (name == -1) {
+            name = static_cast<DFA::StateType>(states.size());
+            states.push_back(state);
+        }
+        return name;
+    };
+
+    for (std::size_t i = 0; i < states.size(); i++) {
+        complement.add_state(static_cast<DFA::StateType>(i));
+        if (!compiled.is_final(states[i])) {
+            complement.add_final_state(static_cast<DFA::StateType>(i));
+        }
+
+        for (auto symbol : alphabet) {
+            complement.add_transition(
+                static_cast<DFA::StateType>(i),
+                add_state(compiled.next_state(states[i], symbol)), symbol);
+        }
+    }
+    complement.set_initial_state(0);
+
+    complement.freeze();
+    return complement;
+}
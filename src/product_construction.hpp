@@ -0,0 +1,33 @@
+#pragma once
+
+#include <span>
+
+#include "dfa.hpp"
+
+enum class ProductOperation {
+    // Words accepted by both DFAs
+    intersect,
+    // Words accepted by either DFA
+    unite,
+    // Words accepted by the first DFA but not the second
+    subtract,
+    // Words accepted by exactly one of the DFAs
+    symmetric_difference,
+};
+
+/**
+ * Combine two DFAs via the product construction, over the union of their
+ * alphabets. Only pairs of states reachable from the pair of initial states
+ * are built, in BFS order, and they are named 0, 1, ... in that order.
+ * Missing transitions lead to an implicit dead state, and pairs from which
+ * the operation can no longer accept are left out like it.
+ */
+DFA build_product_dfa(const DFA &first, const DFA &second,
+                      ProductOperation operation);
+
+/**
+ * The DFA accepting every word over the alphabet which the DFA rejects.
+ * Missing transitions get an explicit final sink state. Words with symbols
+ * outside the alphabet stay rejected.
+ */
+DFA build_complement_dfa(const DFA &dfa, std::span<const char> alphabet);
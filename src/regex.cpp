@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "regex.hpp"
+#include "stats.hpp"
+
+namespace {
+
+// Symbols matched by negated classes and the wildcard
+constexpr char first_printable = '!';
+constexpr char last_printable = '~';
+
+struct Node {
+    enum class Kind {
+        empty,
+        symbols,
+        concatenation,
+        alternation,
+        star,
+        plus,
+        optional,
+    };
+
+    Kind kind;
+    // Sorted symbols matched by a symbols node
+    std::vector<char> symbols;
+    std::vector<Node> children;
+};
+
+class Parser {
+private:
+    std::string_view pattern;
+    std::size_t position = 0;
+
+    [[noreturn]] void fail(const std::string &message) const {
+        throw std::invalid_argument("regex: " + message + " at position " +
+                                    std::to_string(position));
+    }
+
+    [[nodiscard]] bool at_end() const { return position == pattern.size(); }
+    [[nodiscard]] char peek() const { return pattern[position]; }
+
+    Node parse_alternation() {
+        Node alternation{Node::Kind::alternation, {}, {}};
+        alternation.children.push_back(parse_concatenation());
+        while (!at_end() && peek() == '|') {
+            position++;
+            alternation.children.push_back(parse_concatenation());
+        }
+
+        if (alternation.children.size() == 1) {
+            return std::move(alternation.children.front());
+        }
+        return alternation;
+    }
+
+    Node parse_concatenation() {
+        Node concatenation{Node::Kind::concatenation, {}, {}};
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            concatenation.children.push_back(parse_repetition());
+        }
+
+        if (concatenation.children.empty()) {
+            return {Node::Kind::empty, {}, {}};
+        }
+        if (concatenation.children.size() == 1) {
+            return std::move(concatenation.children.front());
+        }
+        return concatenation;
+    }
+
+    Node parse_repetition() {
+        auto node = parse_atom();
+        while (!at_end()) {
+            Node::Kind kind;
+            switch (peek()) {
+            case '*':
+                kind = Node::Kind::star;
+                break;
+            case '+':
+                kind = Node::Kind::plus;
+                break;
+            case '?':
+                kind = Node::Kind::optional;
+                break;
+            default:
+                return node;
+            }
+            position++;
+
+            Node repetition{kind, {}, {}};
+            repetition.children.push_back(std::move(node));
+            node = std::move(repetition);
+        }
+        return node;
+    }
+
+    Node parse_atom() {
+        auto symbol = peek();
+        switch (symbol) {
+        case '(': {
+            position++;
+            auto node = parse_alternation();
+            if (at_end() || peek() != ')') {
+                fail("missing )");
+            }
+            position++;
+            return node;
+        }
+        case '[':
+            return parse_class();
+        case '.':
+            position++;
+            return {Node::Kind::symbols, negate({}), {}};
+        case '*':
+        case '+':
+        case '?':
+            fail(std::string("nothing to repeat with ") + symbol);
+        case ']':
+            fail("unexpected ]");
+        default:
+            return {Node::Kind::symbols, {parse_literal()}, {}};
+        }
+    }
+
+    char parse_literal() {
+        if (peek() == '\\') {
+            position++;
+            if (at_end()) {
+                fail("trailing \\");
+            }
+        }
+        return pattern[position++];
+    }
+
+    Node parse_class() {
+        // Skip [
+        position++;
+
+        bool is_negated = false;
+        if (!at_end() && peek() == '^') {
+            is_negated = true;
+            position++;
+        }
+
+        std::vector<char> symbols;
+        while (!at_end() && peek() != ']') {
+            auto first = parse_literal();
+            auto last = first;
+            if (position + 1 < pattern.size() && peek() == '-' &&
+                pattern[position + 1] != ']') {
+                position++;
+                last = parse_literal();
+                if (last < first) {
+                    fail("invalid range");
+                }
+            }
+
+            for (int symbol = first; symbol <= last; symbol++) {
+                symbols.push_back(static_cast<char>(symbol));
+            }
+        }
+        if (at_end()) {
+            fail("missing ]");
+        }
+        position++;
+
+        std::ranges::sort(symbols);
+        symbols.erase(std::unique(symbols.begin(), symbols.end()),
+                      symbols.end());
+        if (is_negated) {
+            symbols = negate(symbols);
+        }
+        if (symbols.empty()) {
+            fail("empty class");
+        }
+
+        return {Node::Kind::symbols, std::move(symbols), {}};
+    }
+
+    static std::vector<char> negate(const std::vector<char> &symbols) {
+        std::vector<char> negated;
+        for (char symbol = first_printable; symbol <= last_printable;
+             symbol++) {
+            if (!std::ranges::binary_search(symbols, symbol)) {
+                negated.push_back(symbol);
+            }
+        }
+        return negated;
+    }
+
+public:
+    explicit Parser(std::string_view pattern) : pattern(pattern) {}
+
+    Node parse() {
+        auto node = parse_alternation();
+        if (!at_end()) {
+            fail("unmatched )");
+        }
+        return node;
+    }
+};
+
+// Thompson's construction, with one entry and one exit state per fragment
+class ThompsonBuilder {
+public:
+    using StateType = LNFA::StateType;
+
+    struct Fragment {
+        StateType start;
+        StateType end;
+    };
+
+private:
+    LNFA &lnfa;
+    StateType state_count = 0;
+
+    StateType add_state() {
+        lnfa.add_state(state_count);
+        return state_count++;
+    }
+
+    void add_lambda(StateType src_state, StateType dest_state) {
+        lnfa.add_transition(src_state, dest_state, {});
+    }
+
+public:
+    explicit ThompsonBuilder(LNFA &lnfa) : lnfa(lnfa) {}
+
+    Fragment build(const Node &node) {
+        switch (node.kind) {
+        case Node::Kind::empty: {
+            auto state = add_state();
+            return {state, state};
+        }
+        case Node::Kind::symbols: {
+            auto start = add_state();
+            auto end = add_state();
+            for (auto symbol : node.symbols) {
+                lnfa.add_transition(start, end, symbol);
+            }
+            return {start, end};
+        }
+        case Node::Kind::concatenation: {
+            auto fragment = build(node.children.front());
+            for (std::size_t i = 1; i < node.children.size(); i++) {
+                auto next = build(node.children[i]);
+                add_lambda(fragment.end, next.start);
+                fragment.end = next.end;
+            }
+            return fragment;
+        }
+        case Node::Kind::alternation: {
+            auto start = add_state();
+            auto end = add_state();
+            for (const auto &child : node.children) {
+                auto branch = build(child);
+                add_lambda(start, branch.start);
+                add_lambda(branch.end, end);
+            }
+            return {start, end};
+        }
+        case Node::Kind::star:
+        case Node::Kind::plus:
+        case Node::Kind::optional: {
+            auto start = add_state();
+            auto end = add_state();
+            auto inner = build(node.children.front());
+            add_lambda(start, inner.start);
+            add_lambda(inner.end, end);
+            if (node.kind != Node::Kind::plus) {
+                // Skip the inner fragment
+                add_lambda(start, end);
+            }
+            if (node.kind != Node::Kind::optional) {
+                // Repeat the inner fragment
+                add_lambda(inner.end, inner.start);
+            }
+            return {start, end};
+        }
+        }
+
+        throw std::logic_error("regex: unknown node kind");
+    }
+};
+
+// Glushkov's construction. Every symbols node is a position, numbered from 1,
+// and state 0 is the initial state.
+class GlushkovBuilder {
+public:
+    using StateType = NFA::StateType;
+
+    struct Summary {
+        bool is_nullable;
+        // Positions which can start and end words of the node's language
+        std::vector<StateType> first;
+        std::vector<StateType> last;
+    };
+
+private:
+    std::vector<const std::vector<char> *> position_symbols{nullptr};
+    std::vector<std::vector<StateType>> follow{{}};
+
+    static void append(std::vector<StateType> &target,
+                       const std::vector<StateType> &source) {
+        target.insert(target.end(), source.begin(), source.end());
+    }
+
+    void add_follow(const std::vector<StateType> &last,
+                    const std::vector<StateType> &first) {
+        for (auto position : last) {
+            append(follow[position], first);
+        }
+    }
+
+public:
+    Summary summarize(const Node &node) {
+        switch (node.kind) {
+        case Node::Kind::empty:
+            return {true, {}, {}};
+        case Node::Kind::symbols: {
+            StateType position = position_symbols.size();
+            position_symbols.push_back(&node.symbols);
+            follow.emplace_back();
+            return {false, {position}, {position}};
+        }
+        case Node::Kind::concatenation: {
+            auto summary = summarize(node.children.front());
+            for (std::size_t i = 1; i < node.children.size(); i++) {
+                auto next = summarize(node.children[i]);
+                add_follow(summary.last, next.first);
+
+                if (summary.is_nullable) {
+                    append(summary.first, next.first);
+                }
+                if (next.is_nullable) {
+                    append(next.last, summary.last);
+                }
+                summary.last = std::move(next.last);
+                summary.is_nullable &= next.is_nullable;
+            }
+            return summary;
+        }
+        case Node::Kind::alternation: {
+            Summary summary{false, {}, {}};
+            for (const auto &child : node.children) {
+                auto branch = summarize(child);
+                summary.is_nullable |= branch.is_nullable;
+                append(summary.first, branch.first);
+                append(summary.last, branch.last);
+            }
+            return summary;
+        }
+        case Node::Kind::star:
+        case Node::Kind::plus:
+        case Node::Kind::optional: {
+            auto summary = summarize(node.children.front());
+            if (node.kind != Node::Kind::optional) {
+                add_follow(summary.last, summary.first);
+            }
+            if (node.kind != Node::Kind::plus) {
+                summary.is_nullable = true;
+            }
+            return summary;
+        }
+        }
+
+        throw std::logic_error("regex: unknown node kind");
+    }
+
+    void build(const Node &root, NFA &nfa) {
+        auto summary = summarize(root);
+
+        const auto state_count = static_cast<StateType>(follow.size());
+        for (StateType state = 0; state < state_count; state++) {
+            nfa.add_state(state);
+        }
+        nfa.set_initial_state(0);
+
+        // The initial state behaves as if followed by the first positions
+        follow[0] = summary.first;
+        for (StateType src_state = 0; src_state < state_count; src_state++) {
+            auto &dest_states = follow[src_state];
+            std::ranges::sort(dest_states);
+            dest_states.erase(
+                std::unique(dest_states.begin(), dest_states.end()),
+                dest_states.end());
+
+            // Entering a position reads one of its symbols
+            for (auto dest_state : dest_states) {
+                for (auto symbol : *position_symbols[dest_state]) {
+                    nfa.add_transition(src_state, dest_state, symbol);
+                }
+            }
+        }
+
+        for (auto state : summary.last) {
+            nfa.add_final_state(state);
+        }
+        if (summary.is_nullable) {
+            nfa.add_final_state(0);
+        }
+        nfa.freeze();
+    }
+};
+
+} // namespace
+
+LNFA regex_to_lnfa(std::string_view pattern) {
+    AUTOMATA_STATS_PHASE(parse);
+    auto root = Parser(pattern).parse();
+
+    LNFA lnfa;
+    auto fragment = ThompsonBuilder(lnfa).build(root);
+    lnfa.set_initial_state(fragment.start);
+    lnfa.add_final_state(fragment.end);
+    lnfa.build_lambda_closures();
+
+    return lnfa;
+}
+
+NFA regex_to_nfa(std::string_view pattern) {
+    AUTOMATA_STATS_PHASE(parse);
+    auto root = Parser(pattern).parse();
+
+    NFA nfa;
+    GlushkovBuilder().build(root, nfa);
+
+    return nfa;
+}
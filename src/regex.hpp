@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string_view>
+
+#include "lnfa.hpp"
+#include "nfa.hpp"
+
+/*
+ * Regular expressions support:
+ * - literal symbols, with \ escaping any special symbol,
+ * - concatenation, alternation (|) and grouping with parentheses,
+ * - the postfix operators *, + and ?,
+ * - character classes such as [abc] or [a-z0-9], and negated classes such as
+ *   [^ab] and the wildcard ., which match printable ASCII symbols other than
+ *   space, the only ones that can appear in words.
+ *
+ * Malformed expressions throw std::invalid_argument.
+ */
+
+/** Build an LNFA via Thompson's construction. */
+LNFA regex_to_lnfa(std::string_view pattern);
+
+/**
+ * Build a λ-free NFA via Glushkov's construction, with one state per symbol
+ * or class in the pattern, plus the initial state.
+ */
+NFA regex_to_nfa(std::string_view pattern);
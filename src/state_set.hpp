@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+/** A dense bitset over states numbered 0..N-1. */
+class StateSet {
+public:
+    using WordType = std::uint64_t;
+    static constexpr std::size_t word_bits = 64;
+
+private:
+    std::vector<WordType> words;
+
+public:
+    StateSet() = default;
+    explicit StateSet(std::size_t state_count)
+        : words(get_word_count(state_count), 0) {}
+
+    static constexpr std::size_t get_word_count(std::size_t state_count) {
+        return (state_count + word_bits - 1) / word_bits;
+    }
+
+    void insert(std::size_t state) {
+        words[state / word_bits] |= WordType(1) << (state % word_bits);
+    }
+
+    [[nodiscard]] bool contains(std::size_t state) const {
+        return (words[state / word_bits] >> (state % word_bits)) & 1;
+    }
+
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+
+    /** Make room for states up to state_count, keeping the set. */
+    void resize(std::size_t state_count) {
+        words.resize(get_word_count(state_count), 0);
+    }
+
+    [[nodiscard]] bool empty() const {
+        for (auto word : words) {
+            if (word != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::size_t count() const {
+        std::size_t count = 0;
+        for (auto word : words) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool intersects(const StateSet &other) const {
+        return intersects(other.words);
+    }
+
+    [[nodiscard]] bool intersects(std::span<const WordType> other) const {
+        for (std::size_t i = 0; i < words.size(); i++) {
+            if (words[i] & other[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    StateSet &operator|=(const StateSet &other) {
+        unite(other.words.data());
+        return *this;
+    }
+
+    /** Unite with a raw mask of get_words().size() words. */
+    void unite(const WordType *mask) {
+        for (std::size_t i = 0; i < words.size(); i++) {
+            words[i] |= mask[i];
+        }
+    }
+
+    /** Call fn(state) for every state in the set, in increasing order. */
+    template <typename Fn> void for_each(Fn &&fn) const {
+        for_each(words, fn);
+    }
+
+    /** Same as for_each, over the words of a set stored elsewhere. */
+    template <typename Fn>
+    static void for_each(std::span<const WordType> words, Fn &&fn) {
+        for (std::size_t i = 0; i < words.size(); i++) {
+            auto word = words[i];
+            while (word != 0) {
+                fn(i * word_bits + std::countr_zero(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    [[nodiscard]] const std::vector<WordType> &get_words() const {
+        return words;
+    }
+    [[nodiscard]] std::vector<WordType> &get_words() { return words; }
+
+    bool operator==(const StateSet &other) const = default;
+};
+
+template <> struct std::hash<StateSet> {
+    std::size_t operator()(const StateSet &set) const {
+        std::size_t seed = set.get_words().size();
+        for (auto word : set.get_words()) {
+            seed ^= std::hash<StateSet::WordType>{}(word) + 0x9e3779b9 +
+                    (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+/** A transition of a StaticDFA description. */
+struct StaticTransition {
+    std::size_t src_state;
+    std::size_t dest_state;
+    char symbol;
+};
+
+/**
+ * A DFA with at most StateCount states over an alphabet of SymbolCount
+ * symbols, whose tables are std::arrays, so that it can be built, minimized
+ * and matched at compile time, without touching the heap. Matching is
+ * meant to be inlined into the caller.
+ *
+ * States of the description are numbered 0..StateCount-1. As in
+ * CompiledDFA, they are stored shifted by one, after a dead state 0 that
+ * every missing transition leads to, and symbols are mapped to classes
+ * 1..SymbolCount, class 0 being every byte outside the alphabet.
+ *
+ * Invalid descriptions throw std::invalid_argument, which is a compile
+ * error in constant expressions. write_static_dfa_header generates a
+ * StaticDFA from a runtime DFA.
+ */
+template <std::size_t StateCount, std::size_t SymbolCount> class StaticDFA {
+public:
+    using IndexType = std::conditional_t<
+        StateCount < UINT8_MAX, std::uint8_t,
+        std::conditional_t<StateCount < UINT16_MAX, std::uint16_t,
+                           std::uint32_t>>;
+    using ClassType =
+        std::conditional_t<SymbolCount < UINT8_MAX, std::uint8_t,
+                           std::uint16_t>;
+
+    static constexpr IndexType dead_state = 0;
+    static constexpr std::size_t row_count = StateCount + 1;
+    static constexpr std::size_t class_count = SymbolCount + 1;
+
+private:
+    std::array<char, SymbolCount> alphabet{};
+    std::array<ClassType, 256> byte_classes{};
+    std::array<IndexType, row_count * class_count> table{};
+    std::array<bool, row_count> final_states{};
+    IndexType initial_state = dead_state;
+    // Live states, which are 1..state_count
+    std::size_t state_count = 0;
+
+    constexpr StaticDFA() = default;
+
+    template <std::size_t, std::size_t> friend class StaticDFA;
+
+    constexpr void set_alphabet(const std::array<char, SymbolCount> &symbols) {
+        alphabet = symbols;
+        for (std::size_t symbol = 0; symbol < SymbolCount; symbol++) {
+            byte_classes[static_cast<unsigned char>(alphabet[symbol])] =
+                symbol + 1;
+        }
+    }
+
+public:
+    /**
+     * Build from a description. The alphabet lists every symbol once, and
+     * as in DFA::add_transition, a later transition from the same state via
+     * the same symbol replaces an earlier one.
+     */
+    constexpr StaticDFA(std::string_view alphabet, std::size_t initial_state,
+                        std::initializer_list<std::size_t> final_states,
+                        std::initializer_list<StaticTransition> transitions)
+        : state_count(StateCount) {
+        if (alphabet.size() != SymbolCount) {
+            throw std::invalid_argument("wrong alphabet size");
+        }
+        std::array<char, SymbolCount> symbols{};
+        for (std::size_t symbol = 0; symbol < SymbolCount; symbol++) {
+            for (std::size_t other = 0; other < symbol; other++) {
+                if (alphabet[other] == alphabet[symbol]) {
+                    throw std::invalid_argument("repeated symbol");
+                }
+            }
+            symbols[symbol] = alphabet[symbol];
+        }
+        set_alphabet(symbols);
+
+        auto check_state = [](std::size_t state) {
+            if (state >= StateCount) {
+                throw std::invalid_argument("state out of range");
+            }
+        };
+
+        check_state(initial_state);
+        this->initial_state = initial_state + 1;
+        for (auto state : final_states) {
+            check_state(state);
+            this->final_states[state + 1] = true;
+        }
+        for (auto transition : transitions) {
+            check_state(transition.src_state);
+            check_state(transition.dest_state);
+            auto byte_class = get_byte_class(transition.symbol);
+            if (byte_class == 0) {
+                throw std::invalid_argument("symbol not in alphabet");
+            }
+            table[(transition.src_state + 1) * class_count + byte_class] =
+                transition.dest_state + 1;
+        }
+    }
+
+    [[nodiscard]] constexpr std::size_t get_state_count() const {
+        return state_count;
+    }
+    [[nodiscard]] constexpr IndexType get_initial_state() const {
+        return initial_state;
+    }
+    [[nodiscard]] constexpr ClassType get_byte_class(char symbol) const {
+        return byte_classes[static_cast<unsigned char>(symbol)];
+    }
+
+    [[nodiscard]] constexpr IndexType next_state(IndexType state,
+                                                 char symbol) const {
+        return table[state * class_count + get_byte_class(symbol)];
+    }
+    [[nodiscard]] constexpr bool is_final(IndexType state) const {
+        return final_states[state];
+    }
+
+    /** Check if the word is accepted. */
+    [[nodiscard]] constexpr bool accepts(std::string_view word) const {
+        auto state = initial_state;
+        for (auto symbol : word) {
+            state = next_state(state, symbol);
+            if (state == dead_state) {
+                return false;
+            }
+        }
+        return is_final(state);
+    }
+
+    /**
+     * The minimal DFA of the same language, numbered in BFS order from the
+     * initial state like DFA::minimize. The type keeps room for StateCount
+     * states, see shrink. Equivalent states are found by Moore's
+     * refinement, which is quadratic, but simple enough for the small
+     * automata that are built at compile time.
+     */
+    [[nodiscard]] constexpr StaticDFA minimize() const {
+        // Start from final and non final states, then split blocks by the
+        // blocks of their successors until nothing changes
+        std::array<std::size_t, row_count> blocks{};
+        std::size_t block_count = 0;
+        for (std::size_t state = 0; state < row_count; state++) {
+            blocks[state] = final_states[state] ? 1 : 0;
+            block_count = std::max(block_count, blocks[state] + 1);
+        }
+
+        std::array<std::size_t, row_count> new_blocks{};
+        std::array<std::size_t, row_count> representatives{};
+        while (true) {
+            std::size_t new_block_count = 0;
+            for (std::size_t state = 0; state < row_count; state++) {
+                auto is_equivalent = [&](std::size_t other) {
+                    if (blocks[state] != blocks[other]) {
+                        return false;
+                    }
+                    for (std::size_t byte_class = 1; byte_class < class_count;
+                         byte_class++) {
+                        if (blocks[table[state * class_count + byte_class]] !=
+                            blocks[table[other * class_count + byte_class]]) {
+                            return false;
+                        }
+                    }
+                    return true;
+                };
+
+                std::size_t block = 0;
+                while (block < new_block_count &&
+                       !is_equivalent(representatives[block])) {
+                    block++;
+                }
+                if (block == new_block_count) {
+                    representatives[new_block_count++] = state;
+                }
+                new_blocks[state] = block;
+            }
+
+            blocks = new_blocks;
+            if (new_block_count == block_count) {
+                break;
+            }
+            block_count = new_block_count;
+        }
+
+        // Number the live blocks in BFS order, following symbols in
+        // ascending order
+        std::array<ClassType, SymbolCount> sorted_classes{};
+        for (std::size_t byte = 0, i = 0; byte < 256; byte++) {
+            if (byte_classes[byte] != 0) {
+                sorted_classes[i++] = byte_classes[byte];
+            }
+        }
+
+        StaticDFA minimized;
+        minimized.set_alphabet(alphabet);
+        minimized.initial_state = 1;
+        minimized.state_count = 1;
+
+        const auto dead_block = blocks[dead_state];
+        std::array<IndexType, row_count> block_states{};
+        // A representative of every numbered block, in BFS order
+        std::array<std::size_t, row_count> queue{};
+        block_states[blocks[initial_state]] = 1;
+        queue[1] = initial_state;
+        if (blocks[initial_state] == dead_block) {
+            // The language is empty
+            return minimized;
+        }
+
+        for (std::size_t state = 1; state <= minimized.state_count; state++) {
+            const auto representative = queue[state];
+            minimized.final_states[state] = final_states[representative];
+            for (auto byte_class : sorted_classes) {
+                auto dest_block =
+                    blocks[table[representative * class_count + byte_class]];
+                if (dest_block == dead_block) {
+                    continue;
+                }
+                if (block_states[dest_block] == dead_state) {
+                    block_states[dest_block] = ++minimized.state_count;
+                    queue[minimized.state_count] =
+                        table[representative * class_count + byte_class];
+                }
+                minimized.table[state * class_count + byte_class] =
+                    block_states[dest_block];
+            }
+        }
+
+        return minimized;
+    }
+
+    /**
+     * The same DFA in a type with room for NewStateCount states, which
+     * must hold all live states, as in
+     * dfa.minimize().shrink<dfa.minimize().get_state_count()>().
+     */
+    template <std::size_t NewStateCount>
+    [[nodiscard]] constexpr StaticDFA<NewStateCount, SymbolCount>
+    shrink() const {
+        if (state_count > NewStateCount) {
+            throw std::invalid_argument("too many states to shrink");
+        }
+
+        using ShrunkDFA = StaticDFA<NewStateCount, SymbolCount>;
+        using ShrunkIndexType = typename ShrunkDFA::IndexType;
+
+        ShrunkDFA shrunk;
+        shrunk.set_alphabet(alphabet);
+        shrunk.initial_state = static_cast<ShrunkIndexType>(initial_state);
+        shrunk.state_count = state_count;
+        for (std::size_t state = 0; state <= state_count; state++) {
+            shrunk.final_states[state] = final_states[state];
+            for (std::size_t byte_class = 0; byte_class < class_count;
+                 byte_class++) {
+                shrunk.table[state * class_count + byte_class] =
+                    static_cast<ShrunkIndexType>(
+                        table[state * class_count + byte_class]);
+            }
+        }
+        return shrunk;
+    }
+};
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <mutex>
+
+#include "stats.hpp"
+
+namespace stats {
+
+namespace {
+
+constexpr std::array<const char *, std::size_t(Counter::count)>
+    counter_names{
+        "subset_states",
+        "subset_hash_probes",
+        "hopcroft_splitters",
+        "hopcroft_splits",
+        "hopcroft_worklist_peak",
+        "simulation_steps",
+        "simulation_frontier_states",
+        "simulation_frontier_peak",
+    };
+
+constexpr std::array<const char *, std::size_t(Phase::count)> phase_names{
+    "parse",        "closure_build", "construction", "minimization",
+    "compilation",  "matching",      "output",
+};
+
+bool is_max_counter(std::size_t counter) {
+    return counter == std::size_t(Counter::hopcroft_worklist_peak) ||
+           counter == std::size_t(Counter::simulation_frontier_peak);
+}
+
+struct Totals {
+    std::array<std::uint64_t, std::size_t(Counter::count)> counters{};
+    std::array<std::chrono::nanoseconds, std::size_t(Phase::count)>
+        phase_times{};
+
+    void merge(const Totals &other) {
+        for (std::size_t counter = 0; counter < counters.size(); counter++) {
+            counters[counter] =
+                is_max_counter(counter)
+                    ? std::max(counters[counter], other.counters[counter])
+                    : counters[counter] + other.counters[counter];
+        }
+        for (std::size_t phase = 0; phase < phase_times.size(); phase++) {
+            phase_times[phase] += other.phase_times[phase];
+        }
+    }
+};
+
+// Totals of exited threads
+std::mutex exited_mutex;
+Totals exited_totals;
+
+// Every thread counts on its own, so that counting needs no atomics. Its
+// totals are merged when it exits.
+struct ThreadTotals : Totals {
+    PhaseTimer *active_timer = nullptr;
+
+    ~ThreadTotals() {
+        std::lock_guard lock(exited_mutex);
+        exited_totals.merge(*this);
+    }
+};
+
+thread_local ThreadTotals thread_totals;
+
+} // namespace
+
+void add(Counter counter, std::uint64_t value) {
+    thread_totals.counters[std::size_t(counter)] += value;
+}
+
+void record_max(Counter counter, std::uint64_t value) {
+    auto &total = thread_totals.counters[std::size_t(counter)];
+    total = std::max(total, value);
+}
+
+PhaseTimer::PhaseTimer(Phase phase)
+    : phase(phase), start(Clock::now()), parent(thread_totals.active_timer) {
+    if (parent != nullptr) {
+        parent->add_elapsed(start);
+    }
+    thread_totals.active_timer = this;
+}
+
+PhaseTimer::~PhaseTimer() {
+    auto now = Clock::now();
+    add_elapsed(now);
+    thread_totals.active_timer = parent;
+    if (parent != nullptr) {
+        parent->start = now;
+    }
+}
+
+void PhaseTimer::add_elapsed(Clock::time_point now) {
+    thread_totals.phase_times[std::size_t(phase)] += now - start;
+}
+
+void write_json(std::ostream &os) {
+    if (!is_enabled) {
+        os << "{\"enabled\": false}\n";
+        return;
+    }
+
+    Totals totals;
+    {
+        std::lock_guard lock(exited_mutex);
+        totals = exited_totals;
+    }
+    totals.merge(thread_totals);
+
+    os << "{\n  \"enabled\": true,\n  \"counters\": {";
+    for (std::size_t counter = 0; counter < totals.counters.size();
+         counter++) {
+        os << (counter == 0 ? "\n" : ",\n") << "    \""
+           << counter_names[counter] << "\": " << totals.counters[counter];
+    }
+    os << "\n  },\n  \"phase_ms\": {";
+    for (std::size_t phase = 0; phase < totals.phase_times.size(); phase++) {
+        std::chrono::duration<double, std::milli> time =
+            totals.phase_times[phase];
+        os << (phase == 0 ? "\n" : ",\n") << "    \"" << phase_names[phase]
+           << "\": " << time.count();
+    }
+    os << "\n  }\n}\n";
+}
+
+} // namespace stats
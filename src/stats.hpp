@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Statistics for finding out where matching and construction spend their
+// time. They are only kept when built with AUTOMATA_STATS set to 1, via the
+// CMake option of the same name. Otherwise the macros below expand to
+// nothing, and their arguments are never evaluated.
+#ifndef AUTOMATA_STATS
+#define AUTOMATA_STATS 0
+#endif
+
+namespace stats {
+
+enum class Counter {
+    subset_states,
+    subset_hash_probes,
+    hopcroft_splitters,
+    hopcroft_splits,
+    hopcroft_worklist_peak,
+    simulation_steps,
+    simulation_frontier_states,
+    simulation_frontier_peak,
+    count,
+};
+
+enum class Phase {
+    parse,
+    closure_build,
+    construction,
+    minimization,
+    compilation,
+    matching,
+    output,
+    count,
+};
+
+constexpr bool is_enabled = AUTOMATA_STATS != 0;
+
+void add(Counter counter, std::uint64_t value);
+void record_max(Counter counter, std::uint64_t value);
+
+/**
+ * Times a phase from construction to destruction. Nested timers pause the
+ * enclosing one, so every phase only gets its own time.
+ */
+class PhaseTimer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Phase phase;
+    Clock::time_point start;
+    PhaseTimer *parent;
+
+    void add_elapsed(Clock::time_point now);
+
+public:
+    explicit PhaseTimer(Phase phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+/**
+ * Write the statistics of the calling thread and of every thread which has
+ * exited as JSON. Only {"enabled": false} is written without AUTOMATA_STATS.
+ */
+void write_json(std::ostream &os);
+
+} // namespace stats
+
+#if AUTOMATA_STATS
+#define AUTOMATA_STATS_ADD(counter, value)                                     \
+    ::stats::add(::stats::Counter::counter, value)
+#define AUTOMATA_STATS_MAX(counter, value)                                     \
+    ::stats::record_max(::stats::Counter::counter, value)
+#define AUTOMATA_STATS_CONCAT_(a, b) a##b
+#define AUTOMATA_STATS_CONCAT(a, b) AUTOMATA_STATS_CONCAT_(a, b)
+#define AUTOMATA_STATS_PHASE(phase)                                            \
+    ::stats::PhaseTimer AUTOMATA_STATS_CONCAT(stats_phase_timer_, __LINE__)(   \
+        ::stats::Phase::phase)
+#else
+#define AUTOMATA_STATS_ADD(counter, value) ((void)0)
+#define AUTOMATA_STATS_MAX(counter, value) ((void)0)
+#define AUTOMATA_STATS_PHASE(phase) ((void)0)
+#endif
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <bit>
+
+#include "parallel.hpp"
+#include "stats.hpp"
+#include "subset_construction.hpp"
+#include "subset_table.hpp"
+#include "utils.hpp"
+
+DFA build_subset_dfa(const BitsetNFA &nfa, std::ostream *log,
+                     unsigned thread_count) {
+    using StateType = DFA::StateType;
+    using IndexType = SubsetTable::IndexType;
+    AUTOMATA_STATS_PHASE(construction);
+
+    DFA dfa;
+
+    const auto state_count = nfa.get_state_count();
+    const auto symbol_count = nfa.get_symbol_count();
+
+    StateType available_state_name = 0;
+    for (std::size_t state = 0; state < state_count; state++) {
+        available_state_name =
+            std::max(available_state_name, nfa.get_state_name(state) + 1);
+    }
+
+    SubsetTable subsets(nfa.get_word_count());
+    std::vector<StateType> subset_names;
+
+    // Get the DFA state for the subset, adding it if it is new
+    auto add_subset = [&](std::span<const StateSet::WordType> subset,
+                          std::uint64_t hash) {
+        auto [index, was_inserted] = subsets.insert(subset, hash);
+        if (!was_inserted) {
+            return subset_names[index];
+        }
+
+        std::vector<StateType> composing_states;
+        StateSet::for_each(subset, [&](std::size_t state) {
+            composing_states.push_back(nfa.get_state_name(state));
+        });
+
+        StateType new_state;
+        if (composing_states.size() == 1) {
+            // Reuse the name of the NFA's state
+            new_state = composing_states.front();
+        } else {
+            new_state = available_state_name++;
+
+            if (log != nullptr) {
+                std::ranges::sort(composing_states);
+                *log << "New state " << new_state << " = " << composing_states
+                     << '\n';
+            }
+        }
+
+        subset_names.push_back(new_state);
+        dfa.add_state(new_state);
+        if (nfa.contains_final_state(subset)) {
+            // New state contains a final state from the NFA
+            dfa.add_final_state(new_state);
+        }
+
+        return new_state;
+    };
+
+    const auto &initial_words = nfa.get_initial_states().get_words();
+    dfa.set_initial_state(
+        add_subset(initial_words, SubsetTable::hash(initial_words)));
+
+    // Subsets are numbered in discovery order, so walking them by number is
+    // a BFS. They are expanded in blocks: first every (subset, symbol) of the
+    // block is computed and looked up in parallel, with the table read-only,
+    // then the results are added in (subset, symbol) order. New subsets get
+    // the same numbers as in a sequential BFS, whatever the thread count.
+    struct Successor {
+        // Existing subset, or no_subset if there is none
+        IndexType subset = SubsetTable::no_subset;
+        // Where a new subset is kept among its chunk's candidates
+        bool is_new = false;
+        std::uint32_t chunk = 0;
+        std::uint32_t candidate = 0;
+    };
+    struct Candidates {
+        std::vector<StateSet::WordType> words;
+        std::vector<std::uint64_t> hashes;
+    };
+
+    const std::size_t block_size = 256 * thread_count;
+    const std::size_t chunk_count = 4 * thread_count;
+    const auto word_count = nfa.get_word_count();
+    std::vector<Successor> successors;
+    std::vector<Candidates> candidates(chunk_count);
+
+    for (std::size_t block_begin = 0; block_begin < subsets.size();) {
+        const auto block_end =
+            std::min<std::size_t>(block_begin + block_size, subsets.size());
+        successors.assign((block_end - block_begin) * symbol_count, {});
+
+        parallel_for_chunks(
+            block_end - block_begin, chunk_count, thread_count,
+            [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+                auto &chunk_candidates = candidates[chunk];
+                chunk_candidates.words.clear();
+                chunk_candidates.hashes.clear();
+
+                StateSet reached_states(state_count);
+                for (auto i = begin; i < end; i++) {
+                    auto subset_words = subsets.get(block_begin + i);
+                    for (std::size_t symbol = 0; symbol < symbol_count;
+                         symbol++) {
+                        // Union of the successors of every state in the
+                        // subset
+                        reached_states.clear();
+                        StateSet::for_each(
+                            subset_words, [&](std::size_t state) {
+                                nfa.add_successors(state, symbol,
+                                                   reached_states);
+                            });
+
+                        auto &successor = successors[i * symbol_count + symbol];
+                        if (reached_states.empty()) {
+                            continue;
+                        }
+
+                        const auto &words = reached_states.get_words();
+                        auto hash = SubsetTable::hash(words);
+                        successor.subset = subsets.find(words, hash);
+                        if (successor.subset == SubsetTable::no_subset) {
+                            successor.is_new = true;
+                            successor.chunk = chunk;
+                            successor.candidate =
+                                chunk_candidates.hashes.size();
+                            chunk_candidates.words.insert(
+                                chunk_candidates.words.end(), words.begin(),
+                                words.end());
+                            chunk_candidates.hashes.push_back(hash);
+                        }
+                    }
+                }
+            });
+
+        for (auto i = block_begin; i < block_end; i++) {
+            for (std::size_t symbol = 0; symbol < symbol_count; symbol++) {
+                const auto &successor =
+                    successors[(i - block_begin) * symbol_count + symbol];
+
+                StateType dest_state;
+                if (successor.subset != SubsetTable::no_subset) {
+                    dest_state = subset_names[successor.subset];
+                } else if (successor.is_new) {
+                    const auto &chunk_candidates = candidates[successor.chunk];
+                    dest_state = add_subset(
+                        {chunk_candidates.words.data() +
+                             successor.candidate * word_count,
+                         word_count},
+                        chunk_candidates.hashes[successor.candidate]);
+                } else {
+                    continue;
+                }
+
+                dfa.add_transition(subset_names[i], dest_state,
+                                   nfa.get_symbol(symbol));
+            }
+        }
+
+        block_begin = block_end;
+    }
+
+    dfa.freeze();
+    return dfa;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <ostream>
+
+#include "bitset_nfa.hpp"
+#include "dfa.hpp"
+
+/**
+ * Determinize via subset construction, with subsets interned as bitsets.
+ *
+ * DFA states made of a single state keep that state's name, the others get
+ * new names. If log is given, every new combined state is written to it.
+ *
+ * Subsets are expanded on up to thread_count threads. The result, including
+ * state names, does not depend on the thread count.
+ */
+DFA build_subset_dfa(const BitsetNFA &nfa, std::ostream *log = nullptr,
+                     unsigned thread_count = 1);
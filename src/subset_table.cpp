@@ -0,0 +1,79 @@
+#include <algorithm>
+
+#include "stats.hpp"
+#include "subset_table.hpp"
+
+SubsetTable::SubsetTable(std::size_t word_count)
+    : word_count(word_count), slots(64, no_subset) {}
+
+std::uint64_t SubsetTable::hash(std::span<const WordType> subset) {
+    std::uint64_t hash = subset.size();
+    for (auto word : subset) {
+        // Mixing step from splitmix64
+        hash ^= word + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+        hash ^= hash >> 31;
+    }
+    return hash;
+}
+
+SubsetTable::IndexType
+SubsetTable::find(std::span<const WordType> subset,
+                  std::uint64_t subset_hash) const {
+    const auto mask = slots.size() - 1;
+    for (auto slot = subset_hash & mask;; slot = (slot + 1) & mask) {
+        AUTOMATA_STATS_ADD(subset_hash_probes, 1);
+        auto candidate = slots[slot];
+        if (candidate == no_subset) {
+            return no_subset;
+        }
+        if (hashes[candidate] == subset_hash &&
+            std::ranges::equal(get(candidate), subset)) {
+            return candidate;
+        }
+    }
+}
+
+std::pair<SubsetTable::IndexType, bool>
+SubsetTable::insert(std::span<const WordType> subset,
+                    std::uint64_t subset_hash) {
+    const auto mask = slots.size() - 1;
+    auto slot = subset_hash & mask;
+    for (;; slot = (slot + 1) & mask) {
+        AUTOMATA_STATS_ADD(subset_hash_probes, 1);
+        auto candidate = slots[slot];
+        if (candidate == no_subset) {
+            break;
+        }
+        if (hashes[candidate] == subset_hash &&
+            std::ranges::equal(get(candidate), subset)) {
+            return {candidate, false};
+        }
+    }
+
+    IndexType new_subset = hashes.size();
+    arena.insert(arena.end(), subset.begin(), subset.end());
+    hashes.push_back(subset_hash);
+    slots[slot] = new_subset;
+    AUTOMATA_STATS_ADD(subset_states, 1);
+
+    // Keep the load factor at most 1/2
+    if (2 * hashes.size() > slots.size()) {
+        grow();
+    }
+
+    return {new_subset, true};
+}
+
+void SubsetTable::grow() {
+    slots.assign(2 * slots.size(), no_subset);
+    const auto mask = slots.size() - 1;
+    for (IndexType subset = 0; subset < hashes.size(); subset++) {
+        auto slot = hashes[subset] & mask;
+        while (slots[slot] != no_subset) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = subset;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "state_set.hpp"
+
+/**
+ * Interns state subsets, stored as fixed-width bitsets in one contiguous
+ * arena, and numbers them 0, 1, ... in the order they are first seen.
+ * Lookups go through an open-addressing hash table of subset numbers.
+ */
+class SubsetTable {
+public:
+    using IndexType = std::uint32_t;
+    using WordType = StateSet::WordType;
+
+    static constexpr IndexType no_subset = UINT32_MAX;
+
+private:
+    std::size_t word_count;
+    std::vector<WordType> arena;
+    std::vector<std::uint64_t> hashes;
+    // Subset numbers, or no_subset for empty slots. Size is a power of 2.
+    std::vector<IndexType> slots;
+
+    void grow();
+
+public:
+    explicit SubsetTable(std::size_t word_count);
+
+    static std::uint64_t hash(std::span<const WordType> subset);
+
+    [[nodiscard]] std::size_t size() const { return hashes.size(); }
+    [[nodiscard]] std::size_t get_word_count() const { return word_count; }
+
+    /** Valid until the next subset is added. */
+    [[nodiscard]] std::span<const WordType> get(IndexType subset) const {
+        return {arena.data() + subset * word_count, word_count};
+    }
+
+    /** Number of the subset, or no_subset if it was never added. */
+    [[nodiscard]] IndexType find(std::span<const WordType> subset,
+                                 std::uint64_t subset_hash) const;
+    [[nodiscard]] IndexType find(std::span<const WordType> subset) const {
+        return find(subset, hash(subset));
+    }
+
+    /**
+     * Number of the subset, adding it if needed. The flag is true if it was
+     * added.
+     */
+    std::pair<IndexType, bool> insert(std::span<const WordType> subset,
+                                      std::uint64_t subset_hash);
+    std::pair<IndexType, bool> insert(std::span<const WordType> subset) {
+        return insert(subset, hash(subset));
+    }
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+
+/**
+ * Reads whitespace-separated tokens from text in memory, like an istream
+ * would, but without locales or copying. Integers are parsed with
+ * std::from_chars, and words are returned as views into the text.
+ *
+ * After a failed read, all further reads fail too.
+ */
+class TextReader {
+private:
+    std::string_view text;
+    std::size_t position = 0;
+    bool has_failed = false;
+
+    void skip_whitespace() {
+        while (position < text.size() &&
+               (text[position] == ' ' || text[position] == '\n' ||
+                text[position] == '\t' || text[position] == '\r')) {
+            position++;
+        }
+    }
+
+public:
+    explicit TextReader(std::string_view text) : text(text) {}
+
+    template <std::integral T> TextReader &operator>>(T &value) {
+        skip_whitespace();
+        if (has_failed) {
+            return *this;
+        }
+
+        const auto *begin = text.data() + position;
+        auto [end, error] =
+            std::from_chars(begin, text.data() + text.size(), value);
+        if (error != std::errc()) {
+            has_failed = true;
+            return *this;
+        }
+        position += end - begin;
+
+        return *this;
+    }
+
+    /** Read a single non-whitespace character. */
+    TextReader &operator>>(char &symbol) {
+        skip_whitespace();
+        if (has_failed || position == text.size()) {
+            has_failed = true;
+            return *this;
+        }
+
+        symbol = text[position++];
+        return *this;
+    }
+
+    /** Read a word, as a view into the text. */
+    TextReader &operator>>(std::string_view &word) {
+        skip_whitespace();
+        if (has_failed || position == text.size()) {
+            has_failed = true;
+            return *this;
+        }
+
+        auto begin = position;
+        while (position < text.size() && text[position] != ' ' &&
+               text[position] != '\n' && text[position] != '\t' &&
+               text[position] != '\r') {
+            position++;
+        }
+        word = text.substr(begin, position - begin);
+
+        return *this;
+    }
+
+    explicit operator bool() const { return !has_failed; }
+};
@@ -0,0 +1,101 @@
+#include <algorithm>
+
+#include "transition_graph.hpp"
+
+TransitionGraph::IndexType TransitionGraph::add_state(StateType state) {
+    auto [iter, was_inserted] = index_of.try_emplace(
+        state, static_cast<IndexType>(state_names.size()));
+    if (was_inserted) {
+        state_names.push_back(state);
+        is_frozen = false;
+    }
+    return iter->second;
+}
+
+void TransitionGraph::add_transition(StateType src_state,
+                                     StateType dest_state, SymbolType symbol) {
+    auto src_index = add_state(src_state);
+    auto dest_index = add_state(dest_state);
+    pending_sources.push_back(src_index);
+    pending_edges.push_back({dest_index, symbol});
+    is_frozen = false;
+}
+
+void TransitionGraph::freeze() {
+    if (is_frozen) {
+        return;
+    }
+
+    const auto state_count = state_names.size();
+    const auto old_state_count = offsets.size() - 1;
+
+    // Count the edges of every state, old ones included
+    std::vector<IndexType> new_offsets(state_count + 1, 0);
+    for (std::size_t state = 0; state < old_state_count; state++) {
+        new_offsets[state + 1] = offsets[state + 1] - offsets[state];
+    }
+    for (auto src_index : pending_sources) {
+        new_offsets[src_index + 1]++;
+    }
+    for (std::size_t state = 0; state < state_count; state++) {
+        new_offsets[state + 1] += new_offsets[state];
+    }
+
+    // Place old edges before pending ones, keeping the order they were added
+    // in, so that later transitions can replace earlier ones.
+    std::vector<Edge> new_edges(new_offsets.back());
+    auto next_slot = new_offsets;
+    for (std::size_t state = 0; state < old_state_count; state++) {
+        for (auto edge : get_edges(state)) {
+            new_edges[next_slot[state]++] = edge;
+        }
+    }
+    for (std::size_t i = 0; i < pending_edges.size(); i++) {
+        new_edges[next_slot[pending_sources[i]]++] = pending_edges[i];
+    }
+    std::vector<IndexType>().swap(pending_sources);
+    std::vector<Edge>().swap(pending_edges);
+
+    // Sort every state's edges, dropping replaced and duplicate ones
+    std::size_t edge_count = 0;
+    for (std::size_t state = 0; state < state_count; state++) {
+        auto begin = new_edges.begin() + new_offsets[state];
+        auto end = new_edges.begin() + new_offsets[state + 1];
+        new_offsets[state] = edge_count;
+
+        if (is_deterministic) {
+            std::stable_sort(begin, end, [](Edge a, Edge b) {
+                return a.symbol < b.symbol;
+            });
+            for (auto iter = begin; iter != end; iter++) {
+                if (iter + 1 == end || iter[1].symbol != iter->symbol) {
+                    new_edges[edge_count++] = *iter;
+                }
+            }
+        } else {
+            std::sort(begin, end, [](Edge a, Edge b) {
+                return a.symbol != b.symbol ? a.symbol < b.symbol
+                                            : a.dest < b.dest;
+            });
+            end = std::unique(begin, end);
+            for (auto iter = begin; iter != end; iter++) {
+                new_edges[edge_count++] = *iter;
+            }
+        }
+    }
+    new_offsets[state_count] = edge_count;
+    new_edges.resize(edge_count);
+    new_edges.shrink_to_fit();
+
+    offsets = std::move(new_offsets);
+    edges = std::move(new_edges);
+    is_frozen = true;
+}
+
+std::span<const TransitionGraph::Edge>
+TransitionGraph::get_edges(IndexType state, SymbolType symbol) const {
+    auto state_edges = get_edges(state);
+    auto [begin, end] = std::ranges::equal_range(
+        state_edges, symbol, std::less{}, &Edge::symbol);
+    return {begin, end};
+}
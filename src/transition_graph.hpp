@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The transitions of an automaton, in compressed sparse row form.
+ *
+ * States are numbered 0..N-1 in the order they are first seen. Transitions
+ * are collected as pending edges until freeze(), which packs them into one
+ * offsets array and one edge array, with the edges of every state sorted by
+ * symbol and destination. Adding states or transitions afterwards thaws the
+ * graph, and the next freeze() merges the new edges in.
+ *
+ * In a deterministic graph, a transition replaces any earlier one from the
+ * same state via the same symbol. Otherwise, duplicate edges are dropped.
+ */
+class TransitionGraph {
+public:
+    using StateType = int;
+    using IndexType = std::uint32_t;
+    // A byte, or lambda_symbol
+    using SymbolType = std::uint16_t;
+
+    static constexpr SymbolType lambda_symbol = 256;
+    static constexpr IndexType no_state = UINT32_MAX;
+
+    struct Edge {
+        IndexType dest;
+        SymbolType symbol;
+
+        bool operator==(const Edge &) const = default;
+    };
+
+    static SymbolType to_symbol(char symbol) {
+        return static_cast<unsigned char>(symbol);
+    }
+    static char to_char(SymbolType symbol) {
+        return static_cast<char>(symbol);
+    }
+
+private:
+    bool is_deterministic;
+    bool is_frozen = true;
+
+    std::vector<StateType> state_names;
+    std::unordered_map<StateType, IndexType> index_of;
+
+    std::vector<IndexType> pending_sources;
+    std::vector<Edge> pending_edges;
+
+    // Edges of state i are edges[offsets[i]..offsets[i + 1]]
+    std::vector<IndexType> offsets{0};
+    std::vector<Edge> edges;
+
+public:
+    explicit TransitionGraph(bool is_deterministic = false)
+        : is_deterministic(is_deterministic) {}
+
+    /** Index of the state, adding it if it is new. */
+    IndexType add_state(StateType state);
+    void add_transition(StateType src_state, StateType dest_state,
+                        SymbolType symbol);
+
+    /** Pack pending edges into the sorted arrays. */
+    void freeze();
+    [[nodiscard]] bool get_is_frozen() const { return is_frozen; }
+
+    [[nodiscard]] std::size_t get_state_count() const {
+        return state_names.size();
+    }
+    [[nodiscard]] std::size_t get_edge_count() const { return edges.size(); }
+
+    [[nodiscard]] StateType get_state_name(IndexType state) const {
+        return state_names[state];
+    }
+    /** Index of the state, or no_state if it was never added. */
+    [[nodiscard]] IndexType find_state(StateType state) const {
+        auto iter = index_of.find(state);
+        return iter == index_of.end() ? no_state : iter->second;
+    }
+
+    /** Edges from the state, sorted by symbol. Requires a frozen graph. */
+    [[nodiscard]] std::span<const Edge> get_edges(IndexType state) const {
+        return {edges.data() + offsets[state],
+                edges.data() + offsets[state + 1]};
+    }
+    /** Edges from the state via the symbol. Requires a frozen graph. */
+    [[nodiscard]] std::span<const Edge> get_edges(IndexType state,
+                                                  SymbolType symbol) const;
+};
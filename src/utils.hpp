@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iterator>
 #include <ostream>
 #include <unordered_set>